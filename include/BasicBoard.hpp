@@ -0,0 +1,339 @@
+#ifndef BASICBOARD_HPP
+#define BASICBOARD_HPP
+
+#include "SnakeBody.hpp"
+#include "SnakeBuffer.hpp"
+#include "Random.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+//2D board used to snake movement and generating food
+//Size is provided by Size class (see BoardSize.hpp), snake wraps around board edges
+//RandomEngine is used for food and colors, Xoshiro128 by default but std::mt19937 works too
+
+template <class Size, class RandomEngine = Xoshiro128>
+class BasicBoard
+{
+    public:
+        enum Direction { UP = 0, DOWN = 1, LEFT = 2, RIGHT = 3 };
+        SnakeBuffer snake; //Tail is first element and head is last one
+        int foodX, foodY;
+
+        explicit BasicBoard(Size boardSize = Size()); //Seeded from clock
+        BasicBoard(Size boardSize, uint64_t seed); //Same seed gives the same game for the same input
+
+        void reset(); //Start new game, random numbers continue from current state as in BoardBatch::reset()
+
+        int width() const;
+        int height() const;
+
+        void setDirection(Direction dir);
+        Direction getDirection() const;
+        void forceDirection(Direction dir); //Set direction without turn back check, used by replays
+        bool generateFood(); //Returns false when there is no free cell left
+        void addBody();
+        bool moveSnake();
+        bool gotFood();
+        bool foodOnSnake();
+        int segmentsAt(int x, int y); //Number of snake segments on given cell
+
+    private:
+        Size size;
+        RandomEngine randomEngine;
+        Direction snakeDirection;
+
+        //Number of segments on every cell, updated on every head push and tail pop
+        //Counter instead of bit because addBody() places new segment on the same cell as tail
+        std::vector<unsigned short> occupancy;
+
+        //Cells without any segment, food is picked from them with single random number
+        //freeCellIndex stores position of cell in freeCells or -1 if cell is occupied
+        std::vector<int> freeCells;
+        std::vector<int> freeCellIndex;
+
+        void occupyCell(int x, int y);
+        void releaseCell(int x, int y);
+
+        int getRandomNumber(int min, int max);
+
+};
+
+template <class Size, class RandomEngine>
+BasicBoard<Size, RandomEngine>::BasicBoard(Size boardSize) : BasicBoard(boardSize, std::chrono::system_clock::now().time_since_epoch().count())
+{
+}
+
+template <class Size, class RandomEngine>
+BasicBoard<Size, RandomEngine>::BasicBoard(Size boardSize, uint64_t seed) : snake(boardSize.width() * boardSize.height()), size(boardSize),
+    occupancy(boardSize.width() * boardSize.height(), 0), freeCells(boardSize.width() * boardSize.height()),
+    freeCellIndex(boardSize.width() * boardSize.height())
+{
+    randomEngine.seed(seed);
+
+    reset();
+}
+
+template <class Size, class RandomEngine>
+void BasicBoard<Size, RandomEngine>::reset()
+{
+    snake.clear();
+
+    std::fill(occupancy.begin(), occupancy.end(), 0);
+    freeCells.resize(width() * height());
+
+    for (int i = 0; i < width() * height(); i++)
+    {
+        freeCells[i] = i;
+        freeCellIndex[i] = i;
+    }
+
+    //Snake starts in the middle of board (23x12 on 48x27 board)
+    SnakeBody snakeHead;
+
+    snakeHead.setPosition(width() / 2 - 1, height() / 2 - 1);
+    snakeHead.setColor(getRandomNumber(32, 255), getRandomNumber(32, 255), getRandomNumber(32, 255));
+
+    snake.pushHead(snakeHead);
+    occupyCell(snakeHead.positionX, snakeHead.positionY);
+
+    SnakeBody body;
+
+    body.setPosition(width() / 2 - 1, height() / 2);
+    body.setColor(getRandomNumber(32, 255), getRandomNumber(32, 255), getRandomNumber(32, 255));
+
+    snake.pushHead(body);
+    occupyCell(body.positionX, body.positionY);
+
+    snakeDirection = Direction::UP;
+}
+
+template <class Size, class RandomEngine>
+int BasicBoard<Size, RandomEngine>::width() const
+{
+    return size.width();
+}
+
+template <class Size, class RandomEngine>
+int BasicBoard<Size, RandomEngine>::height() const
+{
+    return size.height();
+}
+
+template <class Size, class RandomEngine>
+void BasicBoard<Size, RandomEngine>::setDirection(Direction dir)
+{
+    if (snakeDirection == Direction::LEFT && dir == Direction::RIGHT)
+    {
+        return;
+    }
+
+    if (snakeDirection == Direction::RIGHT && dir == Direction::LEFT)
+    {
+        return;
+    }
+
+    if (snakeDirection == Direction::UP && dir == Direction::DOWN)
+    {
+        return;
+    }
+
+    if (snakeDirection == Direction::DOWN && dir == Direction::UP)
+    {
+        return;
+    }
+
+    snakeDirection = dir;
+}
+
+template <class Size, class RandomEngine>
+typename BasicBoard<Size, RandomEngine>::Direction BasicBoard<Size, RandomEngine>::getDirection() const
+{
+    return snakeDirection;
+}
+
+template <class Size, class RandomEngine>
+void BasicBoard<Size, RandomEngine>::forceDirection(Direction dir)
+{
+    snakeDirection = dir;
+}
+
+//Pick random cell from free cells so it never has to retry
+template <class Size, class RandomEngine>
+bool BasicBoard<Size, RandomEngine>::generateFood()
+{
+    if (freeCells.empty())
+    {
+        return false;
+    }
+
+    int cell = freeCells[getRandomNumber(0, freeCells.size() - 1)];
+
+    foodX = cell % width();
+    foodY = cell / width();
+
+    return true;
+}
+
+template <class Size, class RandomEngine>
+void BasicBoard<Size, RandomEngine>::addBody()
+{
+    SnakeBody lastBody = snake.tail();
+
+    SnakeBody newBody;
+    newBody.setPosition(lastBody.positionX, lastBody.positionY);
+    newBody.setColor(getRandomNumber(32, 255), getRandomNumber(32, 255), getRandomNumber(32, 255));
+
+    if (snake.pushTail(newBody))
+    {
+        occupyCell(newBody.positionX, newBody.positionY);
+    }
+}
+
+template <class Size, class RandomEngine>
+bool BasicBoard<Size, RandomEngine>::moveSnake()
+{
+    //Reuse tail as new head
+    SnakeBody lastBody = snake.popTail();
+    releaseCell(lastBody.positionX, lastBody.positionY);
+
+    lastBody.setPosition(snake.head().positionX, snake.head().positionY);
+
+    switch(snakeDirection)
+    {
+        case Direction::UP:
+            lastBody.positionY--;
+
+            if (lastBody.positionY < 0)
+            {
+                lastBody.positionY = height() - 1;
+            }
+
+            break;
+
+        case Direction::DOWN:
+            lastBody.positionY++;
+
+            if (lastBody.positionY > height() - 1)
+            {
+                lastBody.positionY = 0;
+            }
+
+            break;
+
+        case Direction::LEFT:
+            lastBody.positionX--;
+
+            if (lastBody.positionX < 0)
+            {
+                lastBody.positionX = width() - 1;
+            }
+
+            break;
+
+        case Direction::RIGHT:
+            lastBody.positionX++;
+
+            if (lastBody.positionX > width() - 1)
+            {
+                lastBody.positionX = 0;
+            }
+
+            break;
+    }
+
+    //Segment which is now tail is not counted as collision
+    int hitSegments = segmentsAt(lastBody.positionX, lastBody.positionY);
+
+    if (lastBody.positionX == snake.tail().positionX && lastBody.positionY == snake.tail().positionY)
+    {
+        hitSegments--;
+    }
+
+    snake.pushHead(lastBody);
+    occupyCell(lastBody.positionX, lastBody.positionY);
+
+    return hitSegments == 0;
+}
+
+template <class Size, class RandomEngine>
+bool BasicBoard<Size, RandomEngine>::gotFood()
+{
+    const SnakeBody& head = snake.head();
+
+    if (head.positionX == foodX && head.positionY == foodY)
+    {
+        return true;
+    }
+    else
+    {
+        return false;
+    }
+}
+
+//Head is not taken into account
+template <class Size, class RandomEngine>
+bool BasicBoard<Size, RandomEngine>::foodOnSnake()
+{
+    int segments = segmentsAt(foodX, foodY);
+
+    if (gotFood())
+    {
+        segments--;
+    }
+
+    return segments > 0;
+}
+
+template <class Size, class RandomEngine>
+int BasicBoard<Size, RandomEngine>::segmentsAt(int x, int y)
+{
+    return occupancy[y * width() + x];
+}
+
+//Cell stops being free when first segment enters it
+//It's removed from free cells by moving last free cell in its place
+template <class Size, class RandomEngine>
+void BasicBoard<Size, RandomEngine>::occupyCell(int x, int y)
+{
+    int cell = y * width() + x;
+
+    if (occupancy[cell]++ > 0)
+    {
+        return;
+    }
+
+    int index = freeCellIndex[cell];
+    int lastCell = freeCells.back();
+
+    freeCells[index] = lastCell;
+    freeCellIndex[lastCell] = index;
+
+    freeCells.pop_back();
+    freeCellIndex[cell] = -1;
+}
+
+//Cell becomes free again when last segment leaves it
+template <class Size, class RandomEngine>
+void BasicBoard<Size, RandomEngine>::releaseCell(int x, int y)
+{
+    int cell = y * width() + x;
+
+    if (--occupancy[cell] > 0)
+    {
+        return;
+    }
+
+    freeCellIndex[cell] = freeCells.size();
+    freeCells.push_back(cell);
+}
+
+template <class Size, class RandomEngine>
+int BasicBoard<Size, RandomEngine>::getRandomNumber(int min, int max)
+{
+    return getRandomInRange(randomEngine, min, max);
+}
+
+#endif
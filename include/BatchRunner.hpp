@@ -0,0 +1,65 @@
+#ifndef BATCHRUNNER_HPP
+#define BATCHRUNNER_HPP
+
+#include "BoardBatch.hpp"
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <cstdint>
+#include <functional>
+
+//Runs many boards on all CPU cores
+//Boards are split into BoardBatch shards, every thread starts with its own queue of shards
+//and takes shards from other threads when its queue is empty (work stealing)
+//so threads don't wait when snakes in some shards die earlier than in others
+
+struct BatchRunnerOptions
+{
+    int boardCount = 4096;
+    int batchSize = 256; //Boards in one shard
+    int threadCount = 0; //0 uses all hardware threads
+    bool autoReset = true; //Start new game when snake dies, otherwise board stays dead
+    DynamicBoardSize boardSize;
+    uint64_t seed = 0; //Board n uses seed + n
+};
+
+struct BatchRunnerStats
+{
+    long long boardTicks = 0; //Moves made by alive boards
+    long long games = 0; //Finished games
+    long long stolenShards = 0;
+    double seconds = 0.0;
+};
+
+class BatchRunner
+{
+    public:
+        //Fills actions (Board::Direction values) for every board in shard
+        typedef std::function<void(const BoardBatch& batch, std::vector<unsigned char>& actions, Xoshiro128& randomEngine)> Policy;
+
+        BatchRunner(const BatchRunnerOptions& options);
+
+        void setPolicy(Policy policy); //Random directions are used by default
+        BatchRunnerStats run(int steps); //Make given number of steps on every shard
+
+        int getThreadCount() const;
+        const std::vector<BoardBatch>& getShards() const;
+
+    private:
+        BatchRunnerOptions options;
+        Policy policy;
+
+        std::vector<BoardBatch> shards;
+        std::vector<Xoshiro128> randomEngines; //One per shard so result doesn't depend on thread scheduling
+        std::vector<std::vector<unsigned char>> actions;
+
+        std::vector<std::deque<int>> queues; //Shard indices waiting for every thread
+        std::vector<std::mutex> queueMutexes;
+
+        void workerThread(int thread, int steps, BatchRunnerStats& stats);
+        bool takeShard(int thread, int& shard, bool& stolen);
+        void runShard(int shard, int steps, BatchRunnerStats& stats);
+};
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+//Simple benchmarks which can be run from command line
+//They don't need window or Vulkan device and print results to standard output
+
+class Benchmark
+{
+    public:
+        static void runBoardBenchmark(); //Cost of single tick for growing snake length
+        static void runOccupancyBenchmark(); //Linear scan over snake compared to occupancy lookup
+        static void runBoardSizeBenchmark(); //Ticks per second for runtime and compile time board sizes
+        static void runBatchBenchmark(); //Many boards stepped with BoardBatch compared to separate Board objects
+        static bool runBatchCheck(); //Same game as batch benchmark, false when some board differs from its Board object
+        static void runThreadScalingBenchmark(); //BatchRunner throughput from one thread to all hardware threads
+};
+
+#endif
@@ -1,37 +1,22 @@
 #ifndef BOARD_HPP
 #define BOARD_HPP
 
-#include "SnakeBody.hpp"
+#include "BasicBoard.hpp"
+#include "BoardSize.hpp"
 
-#include <vector>
-#include <random>
-
-//2D board used to snake movement and generating food
-//It has fixed size of 48x27 and snake/food size depends on resolution
+//Board with size selected at runtime, used by game
+//Default size is 48x27 and snake/food size depends on resolution
 //For 1920x1080 it's 40x40
+typedef BasicBoard<DynamicBoardSize> Board;
 
-class Board
-{
-    public:
-        enum Direction { UP = 0, DOWN = 1, LEFT = 2, RIGHT = 3 };
-        std::vector<SnakeBody> snake;
-        int foodX, foodY; 
-
-        Board();
-
-        void setDirection(Direction dir);
-        void generateFood();
-        void addBody();
-        bool moveSnake();
-        bool gotFood();
-        bool foodOnSnake();
-
-    private:
-        std::mt19937 randomEngine;
-        Direction snakeDirection;
+//Boards with size known at compile time
+typedef BasicBoard<StaticBoardSize<48, 27>> Board48x27;
+typedef BasicBoard<StaticBoardSize<64, 32>> Board64x32;
+typedef BasicBoard<StaticBoardSize<128, 64>> Board128x64;
 
-        int getRandomNumber(int min, int max);
-    
-};
+extern template class BasicBoard<DynamicBoardSize>;
+extern template class BasicBoard<StaticBoardSize<48, 27>>;
+extern template class BasicBoard<StaticBoardSize<64, 32>>;
+extern template class BasicBoard<StaticBoardSize<128, 64>>;
 
 #endif
@@ -0,0 +1,76 @@
+#ifndef BOARDBATCH_HPP
+#define BOARDBATCH_HPP
+
+#include "BoardSize.hpp"
+#include "Random.hpp"
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+//Many independent boards of the same size advanced together
+//Every value is kept in its own array indexed by board (structure of arrays) so step() runs
+//simple loops over all boards instead of calling Board methods one board at a time
+//Rules and random number usage are the same as in BasicBoard, so board seeded the same way gives identical game
+
+class BoardBatch
+{
+    public:
+        BoardBatch(int boardCount, DynamicBoardSize boardSize, uint64_t seed); //Board n uses seed + n
+
+        int size() const;
+        int width() const;
+        int height() const;
+
+        void reset(int board); //Start new game on selected board
+        void step(const unsigned char* actions); //Set direction (Board::Direction value) and move every alive board
+
+        bool isAlive(int board) const;
+        bool gotFood(int board) const; //Snake ate food in last step
+        int getLength(int board) const;
+        int getDirection(int board) const;
+        int getHeadX(int board) const;
+        int getHeadY(int board) const;
+        int getFoodX(int board) const;
+        int getFoodY(int board) const;
+        int getSegmentX(int board, int index) const; //Index 0 is tail as in SnakeBuffer
+        int getSegmentY(int board, int index) const;
+        int segmentsAt(int board, int x, int y) const;
+
+    private:
+        int boardCount;
+        DynamicBoardSize boardSize;
+        int cellCount;
+
+        //One value per board
+        std::vector<int> headX, headY;
+        std::vector<int> nextX, nextY;
+        std::vector<int> directions;
+        std::vector<int> lengths;
+        std::vector<int> bodyStart;
+        std::vector<int> foodX, foodY;
+        std::vector<int> freeCount;
+        std::vector<unsigned char> alive;
+        std::vector<unsigned char> ate;
+        std::vector<Xoshiro128> randomEngines;
+
+        //cellCount values per board, board i uses range starting at i * cellCount
+        std::vector<int> bodyCells; //Ring buffer of snake cells
+        std::vector<unsigned short> occupancy;
+        std::vector<int> freeCells;
+        std::vector<int> freeCellIndex;
+
+        int bodyCell(int board, int index) const;
+        void pushHead(int board, int cell);
+        void pushTail(int board, int cell);
+        int popTail(int board);
+        void occupyCell(int board, int cell);
+        void releaseCell(int board, int cell);
+        bool generateFood(int board);
+        void addBody(int board);
+        void skipColor(int board); //Color is not stored but random numbers are taken as in BasicBoard
+
+        int getRandomNumber(int board, int min, int max);
+};
+
+#endif
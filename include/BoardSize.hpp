@@ -0,0 +1,29 @@
+#ifndef BOARDSIZE_HPP
+#define BOARDSIZE_HPP
+
+//Board dimensions used by BasicBoard
+//DynamicBoardSize is set at runtime, StaticBoardSize is known at compile time
+//so wrap-around and cell index math becomes constants (and shifts for power of two width)
+
+class DynamicBoardSize
+{
+    public:
+        DynamicBoardSize() : boardWidth(48), boardHeight(27) {}
+        DynamicBoardSize(int width, int height) : boardWidth(width), boardHeight(height) {}
+
+        int width() const { return boardWidth; }
+        int height() const { return boardHeight; }
+
+    private:
+        int boardWidth, boardHeight;
+};
+
+template <int W, int H>
+class StaticBoardSize
+{
+    public:
+        static constexpr int width() { return W; }
+        static constexpr int height() { return H; }
+};
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef FRAMEWRITER_HPP
+#define FRAMEWRITER_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <fstream>
+
+//Writes captured frames to file on background thread so renderer never waits for disk
+//Renderer owns few pixel buffers, fills one of them and gives it to writer, buffer can be filled again
+//after writer converted and wrote it (waitForBuffer)
+//
+//Format depends on file extension:
+//.ppm - binary PPM images concatenated into one file, or one file per frame when name has printf number (frame%05d.ppm)
+//       such name needs exactly one %d (width like %05d is allowed), other % characters must be written as %%
+//.y4m - YUV4MPEG2 video with 4:4:4 chroma and BT.601 colors, can be played or converted by ffmpeg
+//anything else - raw 8 bit RGB frames without header (ffmpeg -f rawvideo -pix_fmt rgb24)
+
+class FrameWriter
+{
+    public:
+        enum Format
+        {
+            FORMAT_RAW,
+            FORMAT_PPM,
+            FORMAT_Y4M
+        };
+
+        FrameWriter();
+        ~FrameWriter();
+
+        //Input pixels have 4 bytes, BGRA when bgra is true, otherwise RGBA
+        bool open(const std::string& fileName, int width, int height, int bufferCount, bool bgra, int frameRate = 60);
+        void close(); //Write all queued frames and stop thread
+
+        bool isOpen() const;
+        int getWidth() const;
+        int getHeight() const;
+        long long getWrittenFrames() const;
+        bool hasFailed() const; //Some frame couldn't be written
+
+        void waitForBuffer(int buffer); //Block until writer doesn't use buffer anymore
+        void write(int buffer, const unsigned char* pixels); //Pixels must stay valid until buffer is free again
+
+    private:
+        std::string fileName;
+        Format format;
+        bool separateFiles;
+        int width, height;
+        bool bgra;
+        int frameRate;
+
+        std::ofstream stream; //Used when all frames go to one file
+        std::vector<unsigned char> converted; //Only used by writer thread
+
+        std::thread writerThread;
+        mutable std::mutex mutex;
+        std::condition_variable queueChanged;
+        std::deque<std::pair<int, const unsigned char*>> queue; //Buffer and its pixels
+        std::vector<bool> busyBuffers;
+        bool running;
+        bool failed;
+        long long writtenFrames;
+
+        void writerLoop();
+        bool writeFrame(const unsigned char* pixels, long long frame);
+        void convertToRgb(const unsigned char* pixels);
+        void convertToYuv(const unsigned char* pixels);
+};
+
+#endif
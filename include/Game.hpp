@@ -3,11 +3,14 @@
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_vulkan.h>
-#include <random>
+#include <cstdint>
+#include <string>
+#include <vector>
 
 #include "renderer/VulkanRenderer.hpp"
 #include "renderer/ReactangleShape.hpp"
 #include "Board.hpp"
+#include "Replay.hpp"
 
 #define ENABLE_DEBUG false //Enable Vulkan validation layers
 
@@ -16,21 +19,44 @@
 class Game
 {
 public:
-    Game(int width, int height);
+    Game(int width, int height, int boardWidth = 48, int boardHeight = 27, uint64_t seed = 0);
+
+    void setRecordFile(const std::string& fileName); //Save replay of this session when game ends
+    void setReplayFile(const std::string& fileName); //Play replay instead of game (F - fast forward, arrows - seek)
+    void setRendererOptions(const RendererOptions& rendererOptions);
+    void setOffscreen(bool offscreen); //Render without window to offscreen images, only for benchmark
+    void setScreenshotFile(const std::string& fileName); //Save last benchmark frame as PPM, only offscreen
 
     int run();
+    //Render scene with whole board filled for given number of frames and print frame times
+    //Colors change in every frame, static scene is added once as retained shapes and never changes
+    int runBenchmark(int frameCount, bool staticScene = false);
 
 private:
     SDL_Window* mainWindow;
-    std::mt19937 randomEngine;
+    Xoshiro128 randomEngine;
     int windowWidth, windowHeight;
     bool windowed;
+    bool offscreen;
 
     VulkanRenderer vulkanRenderer;
+    RendererOptions rendererOptions;
     Board board;
     ReactangleShape snake, food;
+    std::vector<ShapeHandle> snakeHandles; //Retained shapes of snake bodies, from tail to head like in board
+    ShapeHandle foodHandle;
+
+    uint64_t seed;
+    std::string recordFileName, replayFileName, screenshotFileName;
+    ReplayRecorder replayRecorder;
+    ReplayPlayer replayPlayer;
+    bool fastForward;
 
+    bool createWindow();
     bool initGame();
+    void closeGame();
+    void updateScene(const Board& shownBoard); //Update retained shapes after board changed
+    void printRendererStats();
     int getRandomNumber(int min, int max);
 };
 
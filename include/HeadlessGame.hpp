@@ -0,0 +1,34 @@
+#ifndef HEADLESSGAME_HPP
+#define HEADLESSGAME_HPP
+
+#include "Board.hpp"
+
+#include <string>
+#include <cstdint>
+
+//Runs game without window and renderer
+//Board is moved as fast as possible with scripted directions or simple bot
+//and new board is started every time snake dies or fills whole board
+
+class HeadlessGame
+{
+public:
+    HeadlessGame(int boardWidth, int boardHeight, uint64_t seed); //Game n uses seed + n
+
+    void setScript(const std::string& script); //Directions as U, D, L and R letters, repeated when finished
+    int run(long long ticks); //Make given number of moves and print statistics
+
+    static int playReplay(const std::string& fileName, long long seekTick); //Simulate replay up to given tick (-1 for end) as fast as possible
+
+private:
+    DynamicBoardSize boardSize;
+    uint64_t seed;
+    Board board;
+    std::string script;
+
+    Board::Direction getScriptDirection(long long tick);
+    Board::Direction getBotDirection();
+    bool isSafe(int x, int y);
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <string>
+#include <atomic>
+
+#ifndef ENABLE_PROFILER
+#define ENABLE_PROFILER true //Set to false to remove all zones at compile time
+#endif
+
+//CPU profiler with scoped zones
+//Every thread writes finished zones to its own ring buffer so zones don't need locks, the oldest zones are overwritten
+//when buffer is full. Zones are recorded only after setEnabled(true), otherwise zone only checks one flag.
+//Recorded zones can be saved as Chrome trace JSON (chrome://tracing or ui.perfetto.dev)
+
+class Profiler
+{
+    public:
+        static void setEnabled(bool enabled);
+        static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+        static long long now(); //Nanoseconds since profiler start
+        static void addZone(const char* name, long long start, long long end); //Name must live until export, string literal is expected
+
+        //Should be called when profiled threads don't record zones anymore
+        static bool exportChromeTrace(const std::string& fileName);
+
+    private:
+        static std::atomic<bool> enabled;
+};
+
+//Records time between construction and destruction
+class ProfileZone
+{
+    public:
+        ProfileZone(const char* name) : name(name), start(Profiler::isEnabled() ? Profiler::now() : -1)
+        {
+        }
+
+        ~ProfileZone()
+        {
+            if (start >= 0)
+            {
+                Profiler::addZone(name, start, Profiler::now());
+            }
+        }
+
+    private:
+        const char* name;
+        long long start;
+};
+
+#define PROFILE_ZONE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b) PROFILE_ZONE_CONCAT_IMPL(a, b)
+
+#if ENABLE_PROFILER
+#define PROFILE_ZONE(name) ProfileZone PROFILE_ZONE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name)
+#endif
+
+#endif
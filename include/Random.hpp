@@ -0,0 +1,67 @@
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <cstdint>
+
+//Small and fast random number generator (xoshiro128++)
+//State has 16 bytes instead of 5 KB of std::mt19937 so it's cheap to keep one per board
+//and sequence for given seed is the same on every platform
+
+class Xoshiro128
+{
+    public:
+        typedef uint32_t result_type;
+
+        Xoshiro128(uint64_t seed = 0);
+
+        void seed(uint64_t seed); //Neighbouring seeds give unrelated streams
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return UINT32_MAX; }
+
+        result_type operator()()
+        {
+            uint32_t result = rotate(state[0] + state[3], 7) + state[0];
+            uint32_t t = state[1] << 9;
+
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= t;
+            state[3] = rotate(state[3], 11);
+
+            return result;
+        }
+
+    private:
+        uint32_t state[4];
+
+        static uint32_t rotate(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+};
+
+//Random number from [min, max] range for any engine giving 32 bit numbers
+//Uses multiplication instead of division (Lemire's method), unlike std::uniform_int_distribution
+//result doesn't depend on standard library so seeded games can be replayed everywhere
+template <class Engine>
+int getRandomInRange(Engine& engine, int min, int max)
+{
+    uint32_t range = (uint32_t)(max - min) + 1;
+    uint64_t product = (uint64_t)(uint32_t)engine() * range;
+    uint32_t low = (uint32_t)product;
+
+    if (low < range)
+    {
+        uint32_t threshold = (0u - range) % range;
+
+        while (low < threshold)
+        {
+            product = (uint64_t)(uint32_t)engine() * range;
+            low = (uint32_t)product;
+        }
+    }
+
+    return min + (int)(product >> 32);
+}
+
+#endif
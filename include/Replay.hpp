@@ -0,0 +1,70 @@
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+#include "Board.hpp"
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+//Game replays
+//Replay file has board size, seed and direction used in every tick
+//Directions are stored as runs (number of ticks with the same direction) written as variable length integers
+//so file size depends on number of turns, not on session length
+//
+//File layout (all numbers are varints):
+//"VKSR", version byte, board width, board height, seed, tick count, run count, runs as (length << 2 | direction)
+
+class ReplayRecorder
+{
+    public:
+        void begin(DynamicBoardSize boardSize, uint64_t seed);
+        void addTick(int direction); //Direction used in tick (Board::Direction value)
+        bool save(const std::string& fileName);
+
+        long long getTickCount() const;
+
+    private:
+        DynamicBoardSize boardSize;
+        uint64_t seed;
+        long long tickCount;
+
+        std::vector<uint64_t> runs; //(length << 2) | direction
+};
+
+//Simulates board from replay file
+//Copy of board is kept every few ticks so seeking only simulates ticks from nearest snapshot
+
+class ReplayPlayer
+{
+    public:
+        ReplayPlayer();
+
+        bool load(const std::string& fileName);
+        void setSnapshotInterval(int ticks); //Set before playing, 1000 by default
+
+        bool step(); //Simulate next tick, false when replay ended or snake died
+        void seek(long long tick); //Go to selected tick, forward or backward
+
+        long long getTick() const;
+        long long getTickCount() const;
+        bool isFinished() const;
+        uint64_t getSeed() const;
+        const Board& getBoard() const;
+
+    private:
+        DynamicBoardSize boardSize;
+        uint64_t seed;
+        std::vector<unsigned char> directions; //One per tick
+
+        Board board;
+        long long tick;
+        bool finished;
+
+        int snapshotInterval;
+        std::vector<Board> snapshots; //Snapshot n is board at tick n * snapshotInterval
+
+        void restart();
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef SNAKEBUFFER_HPP
+#define SNAKEBUFFER_HPP
+
+#include "SnakeBody.hpp"
+
+#include <vector>
+
+//Fixed capacity circular buffer holding snake body
+//Index 0 is tail and index size() - 1 is head
+//Pushing head and popping tail are O(1) so moving snake doesn't depend on its length
+
+class SnakeBuffer
+{
+    public:
+        class Iterator
+        {
+            public:
+                Iterator(const SnakeBuffer* buffer, int index) : buffer(buffer), index(index) {}
+
+                const SnakeBody& operator*() const { return (*buffer)[index]; }
+                const SnakeBody* operator->() const { return &(*buffer)[index]; }
+                Iterator& operator++() { index++; return *this; }
+                bool operator!=(const Iterator& other) const { return index != other.index; }
+                bool operator==(const Iterator& other) const { return index == other.index; }
+
+            private:
+                const SnakeBuffer* buffer;
+                int index;
+        };
+
+        SnakeBuffer(int capacity);
+
+        int size() const;
+        int capacity() const;
+        bool empty() const;
+        bool full() const;
+
+        const SnakeBody& operator[](int index) const;
+        SnakeBody& operator[](int index);
+
+        const SnakeBody& head() const;
+        const SnakeBody& tail() const;
+
+        bool pushHead(const SnakeBody& body);
+        bool pushTail(const SnakeBody& body);
+        SnakeBody popTail();
+        void clear();
+
+        Iterator begin() const;
+        Iterator end() const;
+
+    private:
+        std::vector<SnakeBody> bodies;
+        int start, count;
+
+        int physicalIndex(int index) const;
+};
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef EMBEDDEDSHADERS_HPP
+#define EMBEDDEDSHADERS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+//SPIR-V of all shaders, compiled by glslc (-mfmt=num) when game is built and linked into binary
+//so shaders are never loaded from working directory
+
+class EmbeddedShaders
+{
+public:
+    //Name is shader file name without extension (vertexshader, fragmentshader), false for unknown name
+    static bool getShader(const char* name, const uint32_t*& code, size_t& codeSize);
+};
+
+#endif
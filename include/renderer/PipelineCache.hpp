@@ -0,0 +1,37 @@
+#ifndef PIPELINECACHE_HPP
+#define PIPELINECACHE_HPP
+
+#include <string>
+#include <vulkan/vulkan.h>
+
+//Vulkan pipeline cache saved to file, so driver doesn't compile shaders again in next launch
+//
+//File layout: "VKSP", file version (uint32), size of cache data (uint32), cache data from vkGetPipelineCacheData
+//Cache data is used only when its header has vendor, device and cache UUID of current device,
+//otherwise (other GPU, driver update, broken file) cache starts empty and file is replaced when saved
+
+class PipelineCache
+{
+private:
+    VkDevice device;
+    VkPhysicalDeviceProperties properties;
+    std::string fileName;
+
+    VkPipelineCache pipelineCache;
+    bool loaded; //Valid data was loaded from file
+
+    bool isCompatible(const unsigned char* data, size_t size);
+
+public:
+    PipelineCache();
+
+    //Empty file name creates cache which is never saved
+    bool create(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& fileName);
+    void destroy();
+    bool save(); //Written to temporary file first, so file is never left half written
+
+    VkPipelineCache getPipelineCache() const;
+    bool isLoaded() const;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef SHADERRELOADER_HPP
+#define SHADERRELOADER_HPP
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <vulkan/vulkan.h>
+
+#include "VulkanPipeline.hpp"
+
+//Pipeline with shader modules it was created from, they are destroyed together
+struct ReloadedPipeline
+{
+    VulkanPipeline pipeline;
+    std::vector<VkShaderModule> shaderModules;
+    long long lastFrame = -1; //Newest frame which used pipeline, set by renderer when pipeline is replaced
+};
+
+//Watches GLSL sources with inotify and builds new pipeline when some of them is saved, for tuning shaders in running game
+//Everything slow runs on watcher thread: sources are compiled by glslc and pipeline is created by builder given
+//by renderer (Vulkan pipelines can be created while other thread renders). Renderer only takes finished pipeline
+//at frame boundary and never waits for compilation
+//When compilation fails glslc prints errors and current pipeline is kept
+
+class ShaderReloader
+{
+public:
+    //Gets SPIR-V of all sources in order given to start(), shader stage is selected by glslc from file extension
+    typedef std::function<bool(const std::vector<std::vector<uint32_t>>& shaderCode, ReloadedPipeline& pipeline)> Builder;
+
+private:
+    VkDevice device;
+    std::string directory;
+    std::vector<std::string> fileNames;
+    Builder builder;
+
+    int inotifyDescriptor;
+    std::thread watcherThread;
+    std::atomic<bool> stopping;
+
+    std::mutex mutex;
+    bool ready; //Built pipeline waits for renderer
+    ReloadedPipeline readyPipeline;
+
+    void watcherLoop();
+    bool waitForChange(int timeoutMilliseconds); //True when some of watched files was written
+    bool compileShader(const std::string& fileName, std::vector<uint32_t>& code);
+
+public:
+    ShaderReloader();
+    ~ShaderReloader();
+
+    bool start(VkDevice device, const std::string& directory, const std::vector<std::string>& fileNames, Builder builder);
+    void stop(); //Pipeline which wasn't taken is destroyed
+
+    bool isRunning() const;
+    bool takePipeline(ReloadedPipeline& pipeline); //Never blocks, false when there is no new pipeline
+
+    static void destroyPipeline(VkDevice device, ReloadedPipeline& pipeline);
+};
+
+#endif
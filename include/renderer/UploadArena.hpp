@@ -0,0 +1,46 @@
+#ifndef UPLOADARENA_HPP
+#define UPLOADARENA_HPP
+
+#include <vulkan/vulkan.h>
+
+#include "external/vk_mem_alloc.h"
+
+//Linear allocator for data written by CPU every frame (instance data, streamed vertices etc.)
+//It's one host visible buffer mapped for its whole life, allocation only moves offset and returns pointer
+//where data can be written directly, so there is no map/unmap or buffer creation during frame
+//Every frame in flight has its own arena which is reset after fence of that frame was waited
+
+class UploadArena
+{
+private:
+    VmaAllocator allocator;
+    VkBufferUsageFlags usage;
+
+    VkBuffer buffer;
+    VmaAllocation allocation;
+    unsigned char* mappedData;
+    VkDeviceSize size;
+    VkDeviceSize offset; //Start of free space
+    unsigned long long generation; //Increased by every create(), handle of destroyed buffer can be given to new one
+
+public:
+    UploadArena();
+
+    bool create(VmaAllocator allocator, VkDeviceSize size, VkBufferUsageFlags usage);
+    void destroy();
+
+    //Start filling from beginning, GPU mustn't use data of this arena anymore
+    //Buffer is recreated when it's smaller than requiredSize, so one frame never needs more than one buffer
+    bool reset(VkDeviceSize requiredSize = 0);
+
+    //Reserve space and get offset in buffer and pointer to mapped memory, nullptr when arena is full
+    void* allocate(VkDeviceSize dataSize, VkDeviceSize alignment, VkDeviceSize& dataOffset);
+    void flush(); //Make written data visible to GPU, does nothing with coherent memory
+
+    VkBuffer getBuffer() const;
+    VkDeviceSize getSize() const;
+    VkDeviceSize getUsedSize() const;
+    unsigned long long getGeneration() const; //Changes whenever buffer is created again, commands recorded with old buffer are invalid
+};
+
+#endif
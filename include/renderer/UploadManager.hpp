@@ -0,0 +1,75 @@
+#ifndef UPLOADMANAGER_HPP
+#define UPLOADMANAGER_HPP
+
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "external/vk_mem_alloc.h"
+
+//Uploads static data (meshes, later fonts and sprites) to device local memory
+//Data is copied to staging buffer and all uploads queued before submit() are copied by one command buffer (batch)
+//Batch is submitted without waiting, its staging buffers are freed when GPU finished it
+//
+//When device has dedicated transfer queue, copies run on it and buffers are owned by transfer queue family
+//Transfer queue releases ownership at the end of batch and graphics queue acquires it in first frame after submit,
+//that frame also waits for semaphore of batch. Without transfer queue batch is submitted to graphics queue
+//and barrier at its end makes data visible to vertex input of following frames
+
+class UploadManager
+{
+private:
+    struct StagingBuffer
+    {
+        VkBuffer buffer;
+        VmaAllocation allocation;
+    };
+
+    struct UploadBatch
+    {
+        VkCommandBuffer commandBuffer;
+        VkFence fence;
+        VkSemaphore semaphore; //Only with dedicated transfer queue
+        std::vector<StagingBuffer> stagingBuffers;
+        std::vector<VkBufferMemoryBarrier> acquireBarriers; //Recorded by graphics queue
+        bool needsAcquire; //Copied by dedicated transfer queue
+        long long acquireFrame; //Frame which waited for semaphore, -1 until batch is acquired
+    };
+
+    VkDevice device;
+    VmaAllocator allocator;
+
+    uint32_t graphicsQueueFamily;
+    VkQueue transferQueue;
+    uint32_t transferQueueFamily;
+    bool dedicatedTransfer;
+
+    VkCommandPool commandPool;
+
+    UploadBatch recordingBatch; //Copies queued since last submit
+    bool recording;
+    std::vector<UploadBatch> submittedBatches;
+
+    bool beginBatch();
+    void destroyBatch(UploadBatch& batch);
+
+public:
+    UploadManager();
+
+    //Transfer queue is graphics queue when device has no dedicated transfer queue
+    bool init(VkDevice device, VmaAllocator allocator, uint32_t graphicsQueueFamily, VkQueue transferQueue, uint32_t transferQueueFamily);
+    void destroy(); //GPU must be idle
+
+    //Create GPU_ONLY buffer and queue copy of data to it, buffer can be used by frames started after submit()
+    bool uploadBuffer(const void* data, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer& buffer, VmaAllocation& allocation);
+    bool submit(); //Submit queued copies without waiting
+
+    //Record ownership acquire of submitted batches to frame's command buffer and add semaphores which frame has to wait for
+    void acquireUploads(VkCommandBuffer commandBuffer, long long frameNumber, std::vector<VkSemaphore>& waitSemaphores, std::vector<VkPipelineStageFlags>& waitStages);
+    void collectFinished(long long finishedFrame); //Free batches finished by GPU, finishedFrame is the newest frame which is known to be finished
+
+    bool hasUploadsToAcquire() const; //Next frame has to record acquire of some batch
+
+    bool hasDedicatedTransferQueue() const;
+};
+
+#endif
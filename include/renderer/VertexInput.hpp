@@ -1,17 +1,27 @@
 #ifndef VERTEXINPUT_HPP
 #define VERTEXINPUT_HPP
 
-#include <glm/vec3.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
 #include <vector>
+#include <cstdint>
 #include <vulkan/vulkan.h>
 
 //Vertex buffer
 //Used to define and setup vertex buffer for Vulkan pipeline
+//Binding 0 has vertices of shape, binding 1 has one InstanceData for every drawn copy of that shape
+//Shape is drawn with indices so shared vertices are stored once
 
 struct VertexData
 {
-    glm::vec3 position;
-    glm::vec3 color;
+    int8_t position[2]; //R8G8_SNORM, 127 is 1.0 and -127 is -1.0, enough for corners of shape
+};
+
+struct InstanceData
+{
+    glm::vec2 position; //Top left corner in pixels
+    glm::vec2 size;
+    glm::vec4 color;
 };
 
 class VertexInput
@@ -22,6 +32,7 @@ private:
 
 public:
     std::vector <VertexData> vertices;
+    std::vector <uint16_t> indices;
 
     VertexInput();
 
@@ -32,6 +43,8 @@ public:
     VkVertexInputAttributeDescription* getAttributeDescriptions();
 
     size_t getShapeDataSize();
+    size_t getIndexDataSize();
+    size_t getInstanceDataSize(int instanceCount);
 };
 
 #endif
@@ -19,6 +19,7 @@ private:
     VkPipelineRasterizationStateCreateInfo rasterizer;
     VkPipelineMultisampleStateCreateInfo multisampling;
     VkPipelineColorBlendAttachmentState colorBlendAttachment;
+    std::vector<VkDynamicState> dynamicStates;
 
     VkPipeline pipeline;
     VkPipelineLayout pipelineLayout;
@@ -26,7 +27,7 @@ private:
 public:
     VkPipeline getPipeline();
 
-    bool createPipeline(VkDevice device, VkRenderPass renderPass);
+    bool createPipeline(VkDevice device, VkRenderPass renderPass, VkPipelineCache pipelineCache = VK_NULL_HANDLE);
     void destroyPipeline(VkDevice device);
 
     void setViewport(VkViewport viewport);
@@ -39,6 +40,7 @@ public:
     void setRasterizer(VkPolygonMode polygonMode);
     void setMultisampling();
     void setColorBlendAttachment();
+    void addDynamicState(VkDynamicState dynamicState); //State set with command instead of baked into pipeline (viewport set in pipeline is ignored)
 };
 
 #endif
@@ -7,41 +7,176 @@
 #include <SDL2/SDL_vulkan.h>
 #include <vulkan/vulkan.h>
 #include <vector>
+#include <string>
+#include <chrono>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 #include "external/vk_mem_alloc.h"
 
+#include "FrameWriter.hpp"
 #include "VulkanPipeline.hpp"
+#include "UploadArena.hpp"
+#include "UploadManager.hpp"
+#include "PipelineCache.hpp"
+#include "ShaderReloader.hpp"
 #include "VertexInput.hpp"
 #include "ReactangleShape.hpp"
 
 //Main class of Vulkan renderer
 //Initializes Vulkan and some needed things like command buffer, pipeline etc. and provide methods for rendering things
 //Currently it only renders ReactangleShape object
+//Shapes are either retained (added once and kept until removed, see addShape) or drawn only in current frame (draw)
+//Instance data of shapes is written to upload arena of frame and all of them are rendered with one instanced draw call,
+//retained shapes are written to arena only when they changed since the last frame which used the same arena
+//Commands don't contain instance data, so command buffer recorded for swapchain image is submitted again until
+//number of shapes, buffers or pipeline change
+//Few frames can be in flight at once, CPU records next frame while GPU still renders previous ones
+//Frames can be captured, GPU copies them to host visible buffers and writer thread saves them when frame is finished
+//Without window renderer works offscreen, every frame in flight renders to its own image instead of swapchain image
+//and there is no surface, so it runs on devices without presentation support (for example lavapipe)
 
-struct ObjectPushConstants //Push constants 
+struct ScenePushConstants //Push constants, the same for all shapes unless they are drawn one by one (see RendererOptions)
 {
-    glm::vec4 colorVector;
-    glm::mat4 mvpMatrix;
+    glm::mat4 projectionMatrix; //Whole MVP matrix of shape when shapes are drawn one by one
+    glm::vec4 shapeColor; //Only used when shapes are drawn one by one
+    int32_t perShape; //Shader ignores instance data and uses only matrix and color
+};
+
+struct RendererOptions
+{
+    //Render like before instancing for comparing CPU time per frame: MVP matrix of every shape is computed on CPU and pushed
+    //with its color before its own draw call, commands are recorded in every frame because matrices are in them
+    bool drawPerShape = false;
+    bool reuseCommands = true; //Submit commands recorded earlier for the same swapchain image when they would be the same, otherwise record every frame
+    int framesInFlight = 2; //More frames give higher throughput but add latency
+    VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR; //FIFO is used when selected mode isn't supported
+    int gpuTimingLogInterval = 0; //Print GPU times every given number of frames, 0 disables it
+    std::string captureFileName; //Copy every frame to host and write it on background thread (see FrameWriter), empty disables capture
+    int captureBufferCount = 4; //Frames waiting for writer, renderer waits for writer only when all of them are used
+    int captureFrameRate = 60; //Only written to Y4M header
+    std::string shaderDirectory; //Load SPIR-V files (name.spv) from this directory instead of embedded shaders, for shader development
+    std::string shaderSourceDirectory; //Rebuild pipeline when GLSL sources in this directory are saved (needs glslc), empty disables it
+    std::string pipelineCacheFileName = "pipelinecache.bin"; //Compiled pipelines reused by next launch, empty disables saving
+};
+
+typedef int ShapeHandle; //Retained shape, valid until it's removed
+
+struct RendererStats
+{
+    long long frames = 0;
+    long long drawCalls = 0;
+    long long uploadedShapes = 0; //Instance data written by CPU, retained shapes are counted only when they changed
+    long long recordedFrames = 0; //Frames which recorded their commands, others submitted reused command buffer
+    double cpuSeconds = 0.0; //Time spent on recording and submitting commands, without waiting for GPU and swapchain
+    double frameSeconds = 0.0; //Time between starts of consecutive frames
+    double fenceWaitSeconds = 0.0; //Time CPU was blocked waiting for frame slot to be free
+    double latencySeconds = 0.0; //From submit until CPU saw frame finished, summed over latencySamples frames
+    long long latencySamples = 0;
+    double gpuSeconds = 0.0; //GPU time of frames measured with timestamps, summed over gpuSamples frames
+    long long gpuSamples = 0;
+    long long capturedFrames = 0;
+    double captureWaitSeconds = 0.0; //Time CPU was blocked waiting for writer to free capture buffer
+    double initSeconds = 0.0; //Whole initRenderer()
+    double pipelineSeconds = 0.0; //Pipeline creation, much shorter when pipeline cache was loaded
+    bool pipelineCacheLoaded = false;
+};
+
+//GPU times of the newest finished frame, measured with timestamp queries
+struct GpuTimings
+{
+    bool valid = false; //False until first frame finished or when device doesn't support timestamps
+    long long frame = -1; //Number of frame which was measured
+    double frameMilliseconds = 0.0; //Whole command buffer
+    double renderPassMilliseconds = 0.0; //Main render pass
+};
+
+//Timestamps written by every frame, frame n uses queries starting at (n % frames in flight) * TIMESTAMP_COUNT
+enum Timestamp
+{
+    TIMESTAMP_FRAME_BEGIN,
+    TIMESTAMP_RENDER_PASS_BEGIN,
+    TIMESTAMP_RENDER_PASS_END,
+    TIMESTAMP_FRAME_END,
+    TIMESTAMP_COUNT
+};
+
+//Command buffer which is submitted again while everything recorded in it stays the same
+struct RecordedCommands
+{
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    bool valid = false;
+    unsigned long long instanceBufferGeneration = 0; //Buffer of upload arena which commands were recorded with
+    VkDeviceSize instanceOffset = 0;
+    int instanceCount = 0;
+    long long commandsVersion = 0;
+};
+
+//Everything needed by one frame in flight
+struct FrameData
+{
+    VkCommandPool commandPool;
+    VkCommandBuffer commandBuffer; //Recorded in every frame which can't reuse commands
+
+    //Instance data is in arena of frame, so every frame has commands for every swapchain image
+    //Only this frame submits them and it waits for its fence first, so they are never pending when they are submitted again
+    VkCommandPool recordedCommandPool;
+    std::vector<RecordedCommands> recordedCommands;
+
+    VkSemaphore presentSemaphore, renderSemaphore;
+    VkFence renderFence;
+
+    UploadArena uploadArena; //Data written by CPU in this frame
+    VkDeviceSize instanceOffset; //Instance data of drawn shapes in upload arena, retained shapes are first
+    int instanceCount;
+    bool allDirty; //Every retained shape has to be written, arena is new or it was never written
+    std::vector<int> dirtySlots; //Retained shapes changed since they were written to this arena
+    std::vector<unsigned char> slotDirty; //Non zero for slots which are in dirtySlots, so every slot is listed once
+
+    std::vector<VkSemaphore> waitSemaphores; //Semaphores which submit of this frame waits for
+    std::vector<VkPipelineStageFlags> waitStages;
+
+    bool submitted; //Frame was submitted and its results weren't read yet
+    std::chrono::steady_clock::time_point submitTime;
+    long long frameNumber;
+
+    int captureBuffer; //Capture buffer which receives copy of this frame, -1 when frame isn't captured
 };
 
 class VulkanRenderer
 {
     public:
-        bool initRenderer(SDL_Window* window, int width, int height, bool debug); //Init everything
+        bool initRenderer(SDL_Window* window, int width, int height, bool debug, const RendererOptions& options = RendererOptions()); //Init everything, nullptr window renders offscreen
         void destroyRenderer(); //Cleanup everything
         void render(); //Render everything
 
-        void draw(ReactangleShape reactangleShape); //Add object to list
+        void draw(const ReactangleShape& reactangleShape); //Add object to list of this frame only
+
+        ShapeHandle addShape(const ReactangleShape& reactangleShape); //Shape is drawn in every frame until it's removed
+        void updateShape(ShapeHandle shape, const ReactangleShape& reactangleShape); //Nothing is uploaded when shape didn't change
+        void removeShape(ShapeHandle shape);
+        void resize(); //Window size changed
+
+        const RendererStats& getStats() const;
+        const GpuTimings& getGpuTimings() const; //Results are few frames old because they are read only from finished frames
+
+        bool isOffscreen() const;
+        bool readImage(std::vector<unsigned char>& pixels); //RGB pixels of last rendered frame, only in offscreen mode, waits for GPU
+        bool saveImage(const std::string& fileName); //Save last rendered frame as binary PPM, only in offscreen mode
 
     private:
         bool initSuccessful;
         
         int frameNumber;
 
-        VkExtent2D windowExtent;
+        RendererOptions options;
+        RendererStats stats;
+
+        SDL_Window* window;
+        bool offscreen; //Rendering without window and swapchain
+        VkExtent2D viewExtent; //Size of scene given at init
+        VkExtent2D windowExtent; //Size of swapchain images or offscreen images
 
         VkInstance vulkanInstance;
         VkPhysicalDevice physicalDevice;
@@ -50,43 +185,95 @@ class VulkanRenderer
         VkSurfaceKHR vulkanSurface;
         VkQueue graphicsQueue;
         uint32_t graphicsQueueFamily;
+        VkQueue transferQueue; //Graphics queue when device has no dedicated transfer queue
+        uint32_t transferQueueFamily;
         VmaAllocator vmaAllocator;
 
         VkSwapchainKHR vulkanSwapchain;
         VkFormat swapchainImageFormat;
-        std::vector<VkImage> swapchainImages;
+        std::vector<VkImage> swapchainImages; //Offscreen images in offscreen mode
         std::vector<VkImageView> swapchainImageViews;
+        std::vector<VmaAllocation> offscreenImageAllocations;
+        int lastImageIndex; //Image used by last submitted frame, -1 before first frame
+        long long commandsVersion; //Increased when recorded commands can't be reused anymore (new pipeline)
+        bool swapchainOutdated; //Window was resized or swapchain is suboptimal
+
+        std::vector<FrameData> frames; //Frame n uses frames[n % frames.size()]
+        std::vector<VkFence> imagesInFlight; //Fence of last frame which used swapchain image
+
+        std::chrono::steady_clock::time_point lastFrameTime;
 
-        VkCommandPool commandPool;
-        VkCommandBuffer mainCommandBuffer;
+        VkQueryPool timestampQueryPool;
+        bool timestampsSupported;
+        double timestampPeriod; //Nanoseconds per timestamp tick
+        uint64_t timestampMask; //Only valid bits of timestamp are used
+        GpuTimings gpuTimings;
+
+        FrameWriter frameWriter;
+        bool capturing;
+        std::vector<VkBuffer> captureBuffers; //Persistently mapped, written by GPU and read by writer thread
+        std::vector<VmaAllocation> captureAllocations;
+        std::vector<const unsigned char*> captureData;
+        int nextCaptureBuffer; //Capture buffers are used in ring order
 
         VkRenderPass renderPass;
         std::vector<VkFramebuffer> framebuffers;
 
-        VkSemaphore presentSemaphore, renderSemaphore;
-        VkFence renderFence;
-
         VkShaderModule vertexShader, fragmentShader;
+        PipelineCache pipelineCache;
         VulkanPipeline pipeline;
         VkPipelineLayout pipelineLayout;
 
+        ShaderReloader shaderReloader;
+        std::vector<ReloadedPipeline> retiredPipelines; //Replaced pipelines, destroyed when frames which used them are finished
+
+        UploadManager uploadManager; //Static data in device local memory
+
         VmaAllocation allocation;
-        VkBuffer buffer;
+        VkBuffer buffer; //Vertices of rectangle, device local
+        VmaAllocation indexAllocation;
+        VkBuffer indexBuffer;
 
         VertexInput reactangleShape;
 
-        std::vector <ReactangleShape> drawableShapes; //List of objects to draw
+        std::vector <InstanceData> drawableShapes; //List of objects to draw in this frame
+
+        //Retained shapes are packed so they are drawn by one call, removed shape is replaced by the last one
+        std::vector<InstanceData> retainedShapes;
+        std::vector<int> shapeSlots; //Index in retainedShapes for every handle, -1 when handle is free
+        std::vector<ShapeHandle> slotHandles; //Handle of every retained shape
+        std::vector<ShapeHandle> freeHandles;
 
         void initVulkan(SDL_Window* window, bool debug); //Instance, physical device selection and logical device creation
-        void createSwapchain(); //Swapchain creation
-        void createCommands(); //Command pool and command buffer creation
+        bool createSwapchain(); //Swapchain creation
+        bool recreateSwapchain(); //Swapchain recreation after resize
+        bool createOffscreenImages(); //Images used instead of swapchain in offscreen mode, one for every frame in flight
+        void destroySwapchainResources(); //Framebuffers and image views
+        bool isMinimized();
+        void createCommands(); //Command pool and command buffer creation for every frame
+        bool allocateRecordedCommands(); //Reused command buffers for every swapchain image, called again with new swapchain
         void initDefaultRenderPass(); //Init default render pass
-        void initFramebuffers(); //Framebuffers initialization
-        void initSyncStructures(); //Fence and semaphores initialization
-        void createReactangleShape(); //Rectangle shape setup (setup vertex input and allocates buffers)
+        bool initFramebuffers(); //Framebuffers initialization, also after swapchain recreation
+        void initSyncStructures(); //Fence and semaphores initialization for every frame
+        void createTimestampQueryPool(); //Query pool for GPU times if device supports timestamps
+        void readTimestamps(int frameIndex, long long frameNumber); //Read results of finished frame
+        void writeTimestamp(VkCommandBuffer commandBuffer, VkPipelineStageFlagBits stage, int frameIndex, Timestamp timestamp);
+        void createReactangleShape(); //Rectangle shape setup (setup vertex input and uploads vertices)
+        bool createCaptureBuffers(); //Open capture file and create buffers for frame copies
+        void finishCapture(FrameData& frame); //Give copy of finished frame to writer thread
+
+        void markShapeDirty(int slot); //Retained shape has to be written again to arenas of all frames
+        void uploadInstances(FrameData& frame); //Write instance data of drawn shapes to upload arena
+        VkCommandBuffer getCommands(FrameData& frame, int frameIndex, uint32_t imageIndex); //Reused or newly recorded commands of frame
+        void recordCommands(FrameData& frame, VkCommandBuffer commandBuffer, bool reused, int frameIndex, uint32_t imageIndex); //Record frame to command buffer
+        void recordShapeDraws(VkCommandBuffer commandBuffer, const glm::mat4& projection, const std::vector<InstanceData>& shapes);
 
-        VkShaderModule createShaderModule(const char* fileName); //Loading and creating shader module
+        VkShaderModule createShaderModule(const char* name); //Creating shader module from embedded or overriding SPIR-V
+        VkShaderModule createShaderModule(const uint32_t* code, size_t codeSize);
         void initPipeline(); //Initliazing pipeline
+        bool buildPipeline(VulkanPipeline& pipeline, VkShaderModule vertexShader, VkShaderModule fragmentShader); //Pipeline state shared by initial and reloaded pipeline
+        bool buildReloadedPipeline(const std::vector<std::vector<uint32_t>>& shaderCode, ReloadedPipeline& reloaded); //Called on watcher thread
+        void swapReloadedPipeline(long long finishedFrame); //Use newly built pipeline and destroy replaced ones which aren't used anymore
 };
 
 #endif
@@ -0,0 +1,196 @@
+#include "BatchRunner.hpp"
+#include "Profiler.hpp"
+
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+BatchRunner::BatchRunner(const BatchRunnerOptions& options) : options(options)
+{
+    if (this->options.threadCount <= 0)
+    {
+        this->options.threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    this->options.batchSize = std::max(1, this->options.batchSize);
+
+    int shardCount = (options.boardCount + this->options.batchSize - 1) / this->options.batchSize;
+
+    for (int i = 0; i < shardCount; i++)
+    {
+        int boards = std::min(this->options.batchSize, options.boardCount - i * this->options.batchSize);
+
+        //Seeds continue between shards so board n always has seed + n, action streams use seeds after last board
+        shards.push_back(BoardBatch(boards, options.boardSize, options.seed + i * this->options.batchSize));
+        randomEngines.push_back(Xoshiro128(options.seed + options.boardCount + i));
+        actions.push_back(std::vector<unsigned char>(boards));
+    }
+
+    policy = [](const BoardBatch& /*batch*/, std::vector<unsigned char>& actions, Xoshiro128& randomEngine)
+    {
+        for (unsigned char& action : actions)
+        {
+            action = randomEngine() & 3;
+        }
+    };
+
+    queues = std::vector<std::deque<int>>(this->options.threadCount);
+    queueMutexes = std::vector<std::mutex>(this->options.threadCount);
+}
+
+void BatchRunner::setPolicy(Policy policy)
+{
+    this->policy = policy;
+}
+
+BatchRunnerStats BatchRunner::run(int steps)
+{
+    int threadCount = options.threadCount;
+
+    //Shards are dealt to threads in round robin, stealing fixes uneven work later
+    for (int i = 0; i < (int)shards.size(); i++)
+    {
+        queues[i % threadCount].push_back(i);
+    }
+
+    std::vector<BatchRunnerStats> threadStats(threadCount);
+    std::vector<std::thread> threads;
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        threads.push_back(std::thread(&BatchRunner::workerThread, this, i, steps, std::ref(threadStats[i])));
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    auto endTime = std::chrono::steady_clock::now();
+
+    BatchRunnerStats stats;
+
+    for (const BatchRunnerStats& threadStat : threadStats)
+    {
+        stats.boardTicks += threadStat.boardTicks;
+        stats.games += threadStat.games;
+        stats.stolenShards += threadStat.stolenShards;
+    }
+
+    stats.seconds = std::chrono::duration<double>(endTime - startTime).count();
+
+    return stats;
+}
+
+int BatchRunner::getThreadCount() const
+{
+    return options.threadCount;
+}
+
+const std::vector<BoardBatch>& BatchRunner::getShards() const
+{
+    return shards;
+}
+
+void BatchRunner::workerThread(int thread, int steps, BatchRunnerStats& stats)
+{
+    //Counted locally so threads don't write to neighbouring stats all the time
+    BatchRunnerStats localStats;
+
+    int shard;
+    bool stolen;
+
+    //No new shards are added during run so thread can finish when all queues are empty
+    while (takeShard(thread, shard, stolen))
+    {
+        if (stolen)
+        {
+            localStats.stolenShards++;
+        }
+
+        runShard(shard, steps, localStats);
+    }
+
+    stats = localStats;
+}
+
+//Take newest shard from own queue or oldest shard from other thread's queue
+bool BatchRunner::takeShard(int thread, int& shard, bool& stolen)
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutexes[thread]);
+
+        if (!queues[thread].empty())
+        {
+            shard = queues[thread].back();
+            queues[thread].pop_back();
+            stolen = false;
+
+            return true;
+        }
+    }
+
+    for (int i = 1; i < options.threadCount; i++)
+    {
+        int victim = (thread + i) % options.threadCount;
+
+        std::lock_guard<std::mutex> lock(queueMutexes[victim]);
+
+        if (!queues[victim].empty())
+        {
+            shard = queues[victim].front();
+            queues[victim].pop_front();
+            stolen = true;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void BatchRunner::runShard(int shard, int steps, BatchRunnerStats& stats)
+{
+    PROFILE_ZONE("BatchRunner::runShard");
+
+    BoardBatch& batch = shards[shard];
+
+    for (int step = 0; step < steps; step++)
+    {
+        int aliveBoards = 0;
+
+        for (int i = 0; i < batch.size(); i++)
+        {
+            aliveBoards += batch.isAlive(i);
+        }
+
+        //Without reset shard is finished when every snake is dead
+        if (aliveBoards == 0)
+        {
+            break;
+        }
+
+        policy(batch, actions[shard], randomEngines[shard]);
+        batch.step(actions[shard].data());
+
+        stats.boardTicks += aliveBoards;
+
+        int aliveAfterStep = 0;
+
+        for (int i = 0; i < batch.size(); i++)
+        {
+            if (batch.isAlive(i))
+            {
+                aliveAfterStep++;
+            }
+            else if (options.autoReset)
+            {
+                batch.reset(i);
+            }
+        }
+
+        stats.games += aliveBoards - aliveAfterStep;
+    }
+}
@@ -0,0 +1,501 @@
+#include "Benchmark.hpp"
+#include "Board.hpp"
+#include "BoardBatch.hpp"
+#include "BatchRunner.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <thread>
+
+//Plays random game on given board and returns number of ticks per second
+//Board is recreated when snake dies
+template <class BoardType>
+static double measureTicksPerSecond(BoardType board, const std::vector<int>& directions, int ticks)
+{
+    BoardType startBoard = board;
+    board.generateFood();
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < ticks; i++)
+    {
+        board.setDirection((typename BoardType::Direction)directions[i % directions.size()]);
+
+        if (!board.moveSnake())
+        {
+            board = startBoard;
+            board.generateFood();
+        }
+        else if (board.gotFood())
+        {
+            board.addBody();
+            board.generateFood();
+        }
+    }
+
+    auto endTime = std::chrono::steady_clock::now();
+
+    return ticks / std::chrono::duration<double>(endTime - startTime).count();
+}
+
+//Direction to take on every cell to follow cycle through all cells of board, width has to be even
+//Cycle goes down column 0, then up and down other columns below row 0 and back along row 0
+static std::vector<Board::Direction> getCycleDirections(int width, int height)
+{
+    std::vector<int> cells;
+
+    for (int y = 0; y < height; y++)
+    {
+        cells.push_back(y * width);
+    }
+
+    for (int x = 1; x < width; x++)
+    {
+        for (int i = 1; i < height; i++)
+        {
+            int y = (x % 2 == 1) ? height - i : i;
+            cells.push_back(y * width + x);
+        }
+    }
+
+    for (int x = width - 1; x > 0; x--)
+    {
+        cells.push_back(x);
+    }
+
+    std::vector<Board::Direction> directions(cells.size());
+
+    for (int i = 0; i < (int)cells.size(); i++)
+    {
+        int cell = cells[i];
+        int nextCell = cells[(i + 1) % cells.size()];
+
+        if (nextCell == cell + width)
+        {
+            directions[cell] = Board::Direction::DOWN;
+        }
+        else if (nextCell == cell - width)
+        {
+            directions[cell] = Board::Direction::UP;
+        }
+        else if (nextCell == cell + 1)
+        {
+            directions[cell] = Board::Direction::RIGHT;
+        }
+        else
+        {
+            directions[cell] = Board::Direction::LEFT;
+        }
+    }
+
+    return directions;
+}
+
+//Previous snake storage: tail is erased from front of vector and every segment except tail is scanned for collision
+static bool moveVectorSnake(std::vector<SnakeBody>& snake, Board::Direction direction, int width, int height)
+{
+    SnakeBody lastBody = snake[0];
+    snake.erase(snake.begin());
+
+    lastBody.setPosition(snake[snake.size() - 1].positionX, snake[snake.size() - 1].positionY);
+
+    switch(direction)
+    {
+        case Board::Direction::UP:
+            lastBody.positionY = (lastBody.positionY + height - 1) % height;
+            break;
+
+        case Board::Direction::DOWN:
+            lastBody.positionY = (lastBody.positionY + 1) % height;
+            break;
+
+        case Board::Direction::LEFT:
+            lastBody.positionX = (lastBody.positionX + width - 1) % width;
+            break;
+
+        case Board::Direction::RIGHT:
+            lastBody.positionX = (lastBody.positionX + 1) % width;
+            break;
+    }
+
+    snake.push_back(lastBody);
+
+    for (int i = 1; i < (int)snake.size() - 1; i++)
+    {
+        if (lastBody.positionX == snake[i].positionX && lastBody.positionY == snake[i].positionY)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//Snake is grown to given length along cycle through all cells and then follows the cycle, so it never dies
+//Time per tick should stay the same no matter how long snake is, previous vector storage is measured on the same path
+void Benchmark::runBoardBenchmark()
+{
+    const int ticks = 1000000;
+    const int lengths[] = { 2, 16, 128, 512, 1024, 1296 };
+
+    DynamicBoardSize boardSize;
+    std::vector<Board::Direction> directions = getCycleDirections(boardSize.width(), boardSize.height());
+
+    std::cout << "Board tick benchmark (" << ticks << " ticks per length)" << std::endl;
+
+    for (int length : lengths)
+    {
+        Board board(boardSize, 0);
+
+        //Snake grows by one segment after every move like when it eats
+        while (board.snake.size() < length)
+        {
+            board.forceDirection(directions[board.snake.head().positionY * boardSize.width() + board.snake.head().positionX]);
+            board.moveSnake();
+            board.addBody();
+        }
+
+        std::vector<SnakeBody> vectorSnake;
+
+        for (const SnakeBody& snakeBody : board.snake)
+        {
+            vectorSnake.push_back(snakeBody);
+        }
+
+        int alive = 0;
+
+        auto startTime = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < ticks; i++)
+        {
+            board.forceDirection(directions[board.snake.head().positionY * boardSize.width() + board.snake.head().positionX]);
+            alive += board.moveSnake();
+        }
+
+        auto bufferTime = std::chrono::steady_clock::now();
+
+        int vectorAlive = 0;
+
+        for (int i = 0; i < ticks; i++)
+        {
+            const SnakeBody& head = vectorSnake.back();
+            vectorAlive += moveVectorSnake(vectorSnake, directions[head.positionY * boardSize.width() + head.positionX], boardSize.width(),
+                boardSize.height());
+        }
+
+        auto endTime = std::chrono::steady_clock::now();
+
+        double bufferNanoseconds = std::chrono::duration<double, std::nano>(bufferTime - startTime).count();
+        double vectorNanoseconds = std::chrono::duration<double, std::nano>(endTime - bufferTime).count();
+
+        std::cout << "length " << length << ": " << bufferNanoseconds / ticks << " ns/tick, vector " << vectorNanoseconds / ticks
+            << " ns/tick (" << alive << "/" << vectorAlive << " alive ticks)" << std::endl;
+    }
+}
+
+//Same random cells are tested with scan over all segments (previous collision and food check)
+//and with single occupancy lookup
+void Benchmark::runOccupancyBenchmark()
+{
+    const int queries = 1000000;
+    const int lengths[] = { 2, 16, 128, 512, 1024, 1296 };
+
+    DynamicBoardSize boardSize;
+    std::mt19937 randomEngine(0);
+    std::vector<int> cellsX(queries), cellsY(queries);
+
+    for (int i = 0; i < queries; i++)
+    {
+        cellsX[i] = std::uniform_int_distribution<int>{0, boardSize.width() - 1}(randomEngine);
+        cellsY[i] = std::uniform_int_distribution<int>{0, boardSize.height() - 1}(randomEngine);
+    }
+
+    std::cout << "Occupancy benchmark (" << queries << " queries per length)" << std::endl;
+
+    for (int length : lengths)
+    {
+        Board board(boardSize);
+
+        while (board.snake.size() < length)
+        {
+            board.addBody();
+        }
+
+        int scanHits = 0;
+
+        auto startTime = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < queries; i++)
+        {
+            for (const SnakeBody& snakeBody : board.snake)
+            {
+                if (snakeBody.positionX == cellsX[i] && snakeBody.positionY == cellsY[i])
+                {
+                    scanHits++;
+                    break;
+                }
+            }
+        }
+
+        auto scanTime = std::chrono::steady_clock::now();
+
+        int lookupHits = 0;
+
+        for (int i = 0; i < queries; i++)
+        {
+            if (board.segmentsAt(cellsX[i], cellsY[i]) > 0)
+            {
+                lookupHits++;
+            }
+        }
+
+        auto endTime = std::chrono::steady_clock::now();
+
+        double scanNanoseconds = std::chrono::duration<double, std::nano>(scanTime - startTime).count();
+        double lookupNanoseconds = std::chrono::duration<double, std::nano>(endTime - scanTime).count();
+
+        std::cout << "length " << length << ": scan " << scanNanoseconds / queries << " ns, lookup "
+            << lookupNanoseconds / queries << " ns (" << scanHits << "/" << lookupHits << " hits)" << std::endl;
+    }
+}
+
+//Same random game is played on boards with size given at runtime and at compile time
+void Benchmark::runBoardSizeBenchmark()
+{
+    const int ticks = 10000000;
+
+    std::mt19937 randomEngine(0);
+    std::vector<int> directions(4096);
+
+    for (int& direction : directions)
+    {
+        direction = std::uniform_int_distribution<int>{0, 3}(randomEngine);
+    }
+
+    std::cout << "Board size benchmark (" << ticks << " ticks per board)" << std::endl;
+
+    std::cout << "48x27 generic: " << measureTicksPerSecond(Board(DynamicBoardSize(48, 27)), directions, ticks) << " ticks/s" << std::endl;
+    std::cout << "48x27 specialized: " << measureTicksPerSecond(Board48x27(), directions, ticks) << " ticks/s" << std::endl;
+    std::cout << "64x32 generic: " << measureTicksPerSecond(Board(DynamicBoardSize(64, 32)), directions, ticks) << " ticks/s" << std::endl;
+    std::cout << "64x32 specialized: " << measureTicksPerSecond(Board64x32(), directions, ticks) << " ticks/s" << std::endl;
+    std::cout << "128x64 generic: " << measureTicksPerSecond(Board(DynamicBoardSize(128, 64)), directions, ticks) << " ticks/s" << std::endl;
+    std::cout << "128x64 specialized: " << measureTicksPerSecond(Board128x64(), directions, ticks) << " ticks/s" << std::endl;
+
+    //Same game logic with bigger and slower random number generator
+    typedef BasicBoard<DynamicBoardSize, std::mt19937> MersenneBoard;
+
+    std::cout << "48x27 generic with std::mt19937: " << measureTicksPerSecond(MersenneBoard(DynamicBoardSize(48, 27)), directions, ticks)
+        << " ticks/s" << std::endl;
+    std::cout << "Board size in memory: " << sizeof(Board) << " bytes with Xoshiro128, " << sizeof(MersenneBoard) << " bytes with std::mt19937"
+        << std::endl;
+}
+
+//Random actions shared by batch benchmark and check, one value per board for 64 different steps
+static std::vector<unsigned char> getBatchActions(int boardCount)
+{
+    std::mt19937 randomEngine(0);
+    std::vector<unsigned char> actions((size_t)boardCount * 64);
+
+    for (unsigned char& action : actions)
+    {
+        action = std::uniform_int_distribution<int>{0, 3}(randomEngine);
+    }
+
+    return actions;
+}
+
+//Same rules as BoardBatch::step() for single board, returns false when snake died or filled board
+static bool stepBoard(Board& board, Board::Direction action)
+{
+    board.setDirection(action);
+
+    bool alive = board.moveSnake();
+
+    if (alive && board.gotFood())
+    {
+        board.addBody();
+        alive = board.generateFood();
+    }
+
+    return alive;
+}
+
+//Boards are equal when head, direction, length, food and every segment are the same
+static bool isSameBoard(const BoardBatch& batch, int index, bool alive, const Board& board)
+{
+    if (batch.isAlive(index) != alive || batch.getLength(index) != board.snake.size() || batch.getDirection(index) != board.getDirection() ||
+        batch.getHeadX(index) != board.snake.head().positionX || batch.getHeadY(index) != board.snake.head().positionY ||
+        batch.getFoodX(index) != board.foodX || batch.getFoodY(index) != board.foodY)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < board.snake.size(); i++)
+    {
+        if (batch.getSegmentX(index, i) != board.snake[i].positionX || batch.getSegmentY(index, i) != board.snake[i].positionY)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//Same number of boards and random actions for batch and for vector of Board objects
+//Board n is seeded with seed + n like in batch and dead boards are restarted so every step moves every board
+void Benchmark::runBatchBenchmark()
+{
+    const int boardCount = 4096;
+    const int steps = 2000;
+    const uint64_t seed = 0;
+
+    std::vector<unsigned char> actions = getBatchActions(boardCount);
+
+    std::cout << "Batch benchmark (" << boardCount << " boards, " << steps << " steps)" << std::endl;
+
+    BoardBatch batch(boardCount, DynamicBoardSize(), seed);
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    for (int step = 0; step < steps; step++)
+    {
+        batch.step(&actions[(size_t)(step % 64) * boardCount]);
+
+        for (int i = 0; i < boardCount; i++)
+        {
+            if (!batch.isAlive(i))
+            {
+                batch.reset(i);
+            }
+        }
+    }
+
+    auto batchTime = std::chrono::steady_clock::now();
+
+    std::vector<Board> boards;
+
+    for (int i = 0; i < boardCount; i++)
+    {
+        boards.push_back(Board(DynamicBoardSize(), seed + i));
+        boards.back().generateFood();
+    }
+
+    auto boardsStartTime = std::chrono::steady_clock::now();
+
+    for (int step = 0; step < steps; step++)
+    {
+        const unsigned char* stepActions = &actions[(size_t)(step % 64) * boardCount];
+
+        for (int i = 0; i < boardCount; i++)
+        {
+            if (!stepBoard(boards[i], (Board::Direction)stepActions[i]))
+            {
+                boards[i].reset();
+                boards[i].generateFood();
+            }
+        }
+    }
+
+    auto endTime = std::chrono::steady_clock::now();
+
+    double ticks = (double)boardCount * steps;
+    double batchSeconds = std::chrono::duration<double>(batchTime - startTime).count();
+    double boardsSeconds = std::chrono::duration<double>(endTime - boardsStartTime).count();
+
+    std::cout << "BoardBatch: " << ticks / batchSeconds << " board ticks/s" << std::endl;
+    std::cout << "Board objects: " << ticks / boardsSeconds << " board ticks/s" << std::endl;
+}
+
+//Batch benchmark game without timing, every board is compared with its Board object after every step
+bool Benchmark::runBatchCheck()
+{
+    const int boardCount = 4096;
+    const int steps = 2000;
+    const uint64_t seed = 0;
+
+    std::vector<unsigned char> actions = getBatchActions(boardCount);
+
+    std::cout << "Batch check (" << boardCount << " boards, " << steps << " steps)" << std::endl;
+
+    BoardBatch batch(boardCount, DynamicBoardSize(), seed);
+    std::vector<Board> boards;
+
+    for (int i = 0; i < boardCount; i++)
+    {
+        boards.push_back(Board(DynamicBoardSize(), seed + i));
+        boards.back().generateFood();
+    }
+
+    int resets = 0;
+
+    for (int step = 0; step < steps; step++)
+    {
+        const unsigned char* stepActions = &actions[(size_t)(step % 64) * boardCount];
+
+        batch.step(stepActions);
+
+        for (int i = 0; i < boardCount; i++)
+        {
+            bool alive = stepBoard(boards[i], (Board::Direction)stepActions[i]);
+
+            if (!isSameBoard(batch, i, alive, boards[i]))
+            {
+                std::cerr << "Board " << i << " differs after step " << step << std::endl;
+
+                return false;
+            }
+
+            if (!alive)
+            {
+                batch.reset(i);
+                boards[i].reset();
+                boards[i].generateFood();
+                resets++;
+            }
+        }
+    }
+
+    std::cout << "All boards are identical (" << resets << " games restarted)" << std::endl;
+
+    return true;
+}
+
+//Efficiency is speedup divided by number of threads, 100% means perfect scaling
+//Boards are not reset so shards finish at different times and work stealing has something to do
+void Benchmark::runThreadScalingBenchmark()
+{
+    const int steps = 2000;
+
+    int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    BatchRunnerOptions options;
+    options.boardCount = 16384;
+    options.batchSize = 256;
+    options.autoReset = false;
+
+    std::cout << "Thread scaling benchmark (" << options.boardCount << " boards, " << options.batchSize << " per shard, "
+        << steps << " steps, no reset)" << std::endl;
+
+    double singleThreadRate = 0.0;
+
+    for (int threads = 1; threads <= maxThreads; threads = (threads == maxThreads) ? threads + 1 : std::min(threads * 2, maxThreads))
+    {
+        options.threadCount = threads;
+
+        BatchRunner runner(options);
+        BatchRunnerStats stats = runner.run(steps);
+
+        double rate = stats.boardTicks / stats.seconds;
+
+        if (threads == 1)
+        {
+            singleThreadRate = rate;
+        }
+
+        std::cout << threads << " threads: " << rate << " board ticks/s, efficiency " << 100.0 * rate / (singleThreadRate * threads)
+            << "%, " << stats.stolenShards << " stolen shards" << std::endl;
+    }
+}
@@ -0,0 +1,327 @@
+#include "BoardBatch.hpp"
+
+BoardBatch::BoardBatch(int boardCount, DynamicBoardSize boardSize, uint64_t seed) : boardCount(boardCount), boardSize(boardSize),
+    cellCount(boardSize.width() * boardSize.height())
+{
+    headX.resize(boardCount);
+    headY.resize(boardCount);
+    nextX.resize(boardCount);
+    nextY.resize(boardCount);
+    directions.resize(boardCount);
+    lengths.resize(boardCount);
+    bodyStart.resize(boardCount);
+    foodX.resize(boardCount);
+    foodY.resize(boardCount);
+    freeCount.resize(boardCount);
+    alive.resize(boardCount);
+    ate.resize(boardCount);
+
+    bodyCells.resize((size_t)boardCount * cellCount);
+    occupancy.resize((size_t)boardCount * cellCount);
+    freeCells.resize((size_t)boardCount * cellCount);
+    freeCellIndex.resize((size_t)boardCount * cellCount);
+
+    //Every board has its own random stream
+    for (int i = 0; i < boardCount; i++)
+    {
+        randomEngines.push_back(Xoshiro128(seed + i));
+    }
+
+    for (int i = 0; i < boardCount; i++)
+    {
+        reset(i);
+    }
+}
+
+int BoardBatch::size() const
+{
+    return boardCount;
+}
+
+int BoardBatch::width() const
+{
+    return boardSize.width();
+}
+
+int BoardBatch::height() const
+{
+    return boardSize.height();
+}
+
+//Same starting position as in BasicBoard constructor followed by generateFood()
+void BoardBatch::reset(int board)
+{
+    size_t offset = (size_t)board * cellCount;
+
+    for (int i = 0; i < cellCount; i++)
+    {
+        occupancy[offset + i] = 0;
+        freeCells[offset + i] = i;
+        freeCellIndex[offset + i] = i;
+    }
+
+    freeCount[board] = cellCount;
+    lengths[board] = 0;
+    bodyStart[board] = 0;
+
+    int startX = width() / 2 - 1;
+    int startY = height() / 2 - 1;
+
+    skipColor(board);
+    pushHead(board, startY * width() + startX);
+
+    skipColor(board);
+    pushHead(board, (startY + 1) * width() + startX);
+
+    headX[board] = startX;
+    headY[board] = startY + 1;
+    directions[board] = 0; //Board::Direction::UP
+    ate[board] = false;
+
+    alive[board] = generateFood(board);
+}
+
+void BoardBatch::step(const unsigned char* actions)
+{
+    int boardWidth = width();
+    int boardHeight = height();
+
+    //Direction change (snake can't turn back) and new head position with wrap-around
+    //No branches so compiler can vectorize this loop
+    for (int i = 0; i < boardCount; i++)
+    {
+        int current = directions[i];
+        int action = actions[i];
+
+        //Opposite directions differ only in lowest bit (UP/DOWN and LEFT/RIGHT)
+        int direction = (action == (current ^ 1)) ? current : action;
+        direction = alive[i] ? direction : current;
+
+        int x = headX[i] + (direction == 3) - (direction == 2);
+        int y = headY[i] + (direction == 1) - (direction == 0);
+
+        x = x < 0 ? boardWidth - 1 : x;
+        x = x > boardWidth - 1 ? 0 : x;
+        y = y < 0 ? boardHeight - 1 : y;
+        y = y > boardHeight - 1 ? 0 : y;
+
+        directions[i] = direction;
+        nextX[i] = x;
+        nextY[i] = y;
+    }
+
+    //Move tail to new head position and check collision with occupancy grid
+    for (int i = 0; i < boardCount; i++)
+    {
+        if (!alive[i])
+        {
+            ate[i] = false;
+            continue;
+        }
+
+        int cell = nextY[i] * boardWidth + nextX[i];
+
+        releaseCell(i, popTail(i));
+
+        //Segment which is now tail is not counted as collision
+        int hitSegments = occupancy[(size_t)i * cellCount + cell] - (cell == bodyCell(i, 0));
+
+        pushHead(i, cell);
+
+        headX[i] = nextX[i];
+        headY[i] = nextY[i];
+
+        alive[i] = hitSegments == 0;
+        ate[i] = alive[i] && headX[i] == foodX[i] && headY[i] == foodY[i];
+    }
+
+    //Growing and new food only for boards which got food
+    for (int i = 0; i < boardCount; i++)
+    {
+        if (ate[i])
+        {
+            addBody(i);
+
+            //Snake fills whole board
+            alive[i] = generateFood(i);
+        }
+    }
+}
+
+bool BoardBatch::isAlive(int board) const
+{
+    return alive[board];
+}
+
+bool BoardBatch::gotFood(int board) const
+{
+    return ate[board];
+}
+
+int BoardBatch::getLength(int board) const
+{
+    return lengths[board];
+}
+
+int BoardBatch::getDirection(int board) const
+{
+    return directions[board];
+}
+
+int BoardBatch::getHeadX(int board) const
+{
+    return headX[board];
+}
+
+int BoardBatch::getHeadY(int board) const
+{
+    return headY[board];
+}
+
+int BoardBatch::getFoodX(int board) const
+{
+    return foodX[board];
+}
+
+int BoardBatch::getFoodY(int board) const
+{
+    return foodY[board];
+}
+
+int BoardBatch::getSegmentX(int board, int index) const
+{
+    return bodyCell(board, index) % width();
+}
+
+int BoardBatch::getSegmentY(int board, int index) const
+{
+    return bodyCell(board, index) / width();
+}
+
+int BoardBatch::segmentsAt(int board, int x, int y) const
+{
+    return occupancy[(size_t)board * cellCount + y * width() + x];
+}
+
+int BoardBatch::bodyCell(int board, int index) const
+{
+    int physical = bodyStart[board] + index;
+
+    if (physical >= cellCount)
+    {
+        physical -= cellCount;
+    }
+
+    return bodyCells[(size_t)board * cellCount + physical];
+}
+
+void BoardBatch::pushHead(int board, int cell)
+{
+    int physical = bodyStart[board] + lengths[board];
+
+    if (physical >= cellCount)
+    {
+        physical -= cellCount;
+    }
+
+    bodyCells[(size_t)board * cellCount + physical] = cell;
+    lengths[board]++;
+
+    occupyCell(board, cell);
+}
+
+void BoardBatch::pushTail(int board, int cell)
+{
+    bodyStart[board] = (bodyStart[board] == 0) ? cellCount - 1 : bodyStart[board] - 1;
+    bodyCells[(size_t)board * cellCount + bodyStart[board]] = cell;
+    lengths[board]++;
+
+    occupyCell(board, cell);
+}
+
+int BoardBatch::popTail(int board)
+{
+    int cell = bodyCells[(size_t)board * cellCount + bodyStart[board]];
+
+    bodyStart[board]++;
+
+    if (bodyStart[board] == cellCount)
+    {
+        bodyStart[board] = 0;
+    }
+
+    lengths[board]--;
+
+    return cell;
+}
+
+//Free cells are updated exactly like in BasicBoard so food is picked from the same list
+void BoardBatch::occupyCell(int board, int cell)
+{
+    size_t offset = (size_t)board * cellCount;
+
+    if (occupancy[offset + cell]++ > 0)
+    {
+        return;
+    }
+
+    int index = freeCellIndex[offset + cell];
+    int lastCell = freeCells[offset + freeCount[board] - 1];
+
+    freeCells[offset + index] = lastCell;
+    freeCellIndex[offset + lastCell] = index;
+
+    freeCount[board]--;
+    freeCellIndex[offset + cell] = -1;
+}
+
+void BoardBatch::releaseCell(int board, int cell)
+{
+    size_t offset = (size_t)board * cellCount;
+
+    if (--occupancy[offset + cell] > 0)
+    {
+        return;
+    }
+
+    freeCellIndex[offset + cell] = freeCount[board];
+    freeCells[offset + freeCount[board]] = cell;
+    freeCount[board]++;
+}
+
+bool BoardBatch::generateFood(int board)
+{
+    if (freeCount[board] == 0)
+    {
+        return false;
+    }
+
+    int cell = freeCells[(size_t)board * cellCount + getRandomNumber(board, 0, freeCount[board] - 1)];
+
+    foodX[board] = cell % width();
+    foodY[board] = cell / width();
+
+    return true;
+}
+
+void BoardBatch::addBody(int board)
+{
+    skipColor(board);
+
+    if (lengths[board] < cellCount)
+    {
+        pushTail(board, bodyCell(board, 0));
+    }
+}
+
+void BoardBatch::skipColor(int board)
+{
+    getRandomNumber(board, 32, 255);
+    getRandomNumber(board, 32, 255);
+    getRandomNumber(board, 32, 255);
+}
+
+int BoardBatch::getRandomNumber(int board, int min, int max)
+{
+    return getRandomInRange(randomEngines[board], min, max);
+}
@@ -0,0 +1,304 @@
+#include "FrameWriter.hpp"
+#include "Profiler.hpp"
+
+#include <cstdio>
+
+static bool hasExtension(const std::string& fileName, const std::string& extension)
+{
+    return fileName.size() >= extension.size() && fileName.compare(fileName.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+//File name is used as printf format, so it may only have one integer conversion (like %d or %05d) and escaped %%
+static bool isFrameNumberPattern(const std::string& fileName)
+{
+    int conversions = 0;
+
+    for (size_t i = 0; i < fileName.size(); i++)
+    {
+        if (fileName[i] != '%')
+        {
+            continue;
+        }
+
+        i++;
+
+        if (i < fileName.size() && fileName[i] == '%')
+        {
+            continue;
+        }
+
+        if (i < fileName.size() && fileName[i] == '0')
+        {
+            i++;
+        }
+
+        while (i < fileName.size() && fileName[i] >= '0' && fileName[i] <= '9')
+        {
+            i++;
+        }
+
+        if (i >= fileName.size() || fileName[i] != 'd')
+        {
+            return false;
+        }
+
+        conversions++;
+    }
+
+    return conversions == 1;
+}
+
+FrameWriter::FrameWriter() : width(0), height(0), running(false), failed(false), writtenFrames(0)
+{
+}
+
+FrameWriter::~FrameWriter()
+{
+    close();
+}
+
+bool FrameWriter::open(const std::string& fileName, int width, int height, int bufferCount, bool bgra, int frameRate)
+{
+    close();
+
+    if (width <= 0 || height <= 0 || bufferCount <= 0)
+    {
+        return false;
+    }
+
+    this->fileName = fileName;
+    this->width = width;
+    this->height = height;
+    this->bgra = bgra;
+    this->frameRate = frameRate > 0 ? frameRate : 60;
+
+    if (hasExtension(fileName, ".ppm"))
+    {
+        format = FORMAT_PPM;
+    }
+    else if (hasExtension(fileName, ".y4m"))
+    {
+        format = FORMAT_Y4M;
+    }
+    else
+    {
+        format = FORMAT_RAW;
+    }
+
+    separateFiles = format == FORMAT_PPM && fileName.find('%') != std::string::npos;
+
+    if (separateFiles && !isFrameNumberPattern(fileName))
+    {
+        return false;
+    }
+
+    if (!separateFiles)
+    {
+        stream.open(fileName, std::ios::binary);
+
+        if (!stream.is_open())
+        {
+            return false;
+        }
+
+        if (format == FORMAT_Y4M)
+        {
+            stream << "YUV4MPEG2 W" << width << " H" << height << " F" << this->frameRate << ":1 Ip A1:1 C444\n";
+        }
+    }
+
+    busyBuffers = std::vector<bool>(bufferCount, false);
+    queue.clear();
+    failed = false;
+    writtenFrames = 0;
+
+    running = true;
+    writerThread = std::thread(&FrameWriter::writerLoop, this);
+
+    return true;
+}
+
+void FrameWriter::close()
+{
+    if (!running)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+
+    queueChanged.notify_all();
+    writerThread.join();
+
+    if (stream.is_open())
+    {
+        stream.close();
+    }
+}
+
+bool FrameWriter::isOpen() const
+{
+    return running;
+}
+
+int FrameWriter::getWidth() const
+{
+    return width;
+}
+
+int FrameWriter::getHeight() const
+{
+    return height;
+}
+
+long long FrameWriter::getWrittenFrames() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return writtenFrames;
+}
+
+bool FrameWriter::hasFailed() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return failed;
+}
+
+void FrameWriter::waitForBuffer(int buffer)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    queueChanged.wait(lock, [&]() { return !busyBuffers[buffer]; });
+}
+
+void FrameWriter::write(int buffer, const unsigned char* pixels)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        busyBuffers[buffer] = true;
+        queue.push_back(std::make_pair(buffer, pixels));
+    }
+
+    queueChanged.notify_all();
+}
+
+//Frames are written in the same order as they were given, thread ends when queue is empty after close()
+void FrameWriter::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true)
+    {
+        queueChanged.wait(lock, [&]() { return !queue.empty() || !running; });
+
+        if (queue.empty())
+        {
+            break;
+        }
+
+        int buffer = queue.front().first;
+        const unsigned char* pixels = queue.front().second;
+        long long frame = writtenFrames;
+
+        //Buffer stays busy while it's converted so renderer doesn't overwrite it
+        lock.unlock();
+
+        bool written = writeFrame(pixels, frame);
+
+        lock.lock();
+
+        queue.pop_front();
+        busyBuffers[buffer] = false;
+        writtenFrames++;
+        failed = failed || !written;
+
+        queueChanged.notify_all();
+    }
+}
+
+bool FrameWriter::writeFrame(const unsigned char* pixels, long long frame)
+{
+    PROFILE_ZONE("FrameWriter::writeFrame");
+
+    if (format == FORMAT_Y4M)
+    {
+        convertToYuv(pixels);
+
+        stream << "FRAME\n";
+        stream.write((const char*)converted.data(), converted.size());
+
+        return stream.good();
+    }
+
+    convertToRgb(pixels);
+
+    std::ofstream frameFile;
+    std::ofstream* output = &stream;
+
+    if (separateFiles)
+    {
+        std::vector<char> frameFileName(fileName.size() + 32);
+        snprintf(frameFileName.data(), frameFileName.size(), fileName.c_str(), (int)frame);
+
+        frameFile.open(frameFileName.data(), std::ios::binary);
+        output = &frameFile;
+    }
+
+    if (format == FORMAT_PPM)
+    {
+        *output << "P6\n" << width << " " << height << "\n255\n";
+    }
+
+    output->write((const char*)converted.data(), converted.size());
+
+    return output->good();
+}
+
+void FrameWriter::convertToRgb(const unsigned char* pixels)
+{
+    int pixelCount = width * height;
+
+    converted.resize(pixelCount * 3);
+
+    int red = bgra ? 2 : 0;
+    int blue = bgra ? 0 : 2;
+
+    for (int i = 0; i < pixelCount; i++)
+    {
+        converted[i * 3] = pixels[i * 4 + red];
+        converted[i * 3 + 1] = pixels[i * 4 + 1];
+        converted[i * 3 + 2] = pixels[i * 4 + blue];
+    }
+}
+
+//BT.601 limited range in integer math, planes are Y, Cb, Cr
+//Offsets keep values positive before shift
+void FrameWriter::convertToYuv(const unsigned char* pixels)
+{
+    int pixelCount = width * height;
+
+    converted.resize(pixelCount * 3);
+
+    unsigned char* yPlane = converted.data();
+    unsigned char* cbPlane = yPlane + pixelCount;
+    unsigned char* crPlane = cbPlane + pixelCount;
+
+    int red = bgra ? 2 : 0;
+    int blue = bgra ? 0 : 2;
+
+    for (int i = 0; i < pixelCount; i++)
+    {
+        int r = pixels[i * 4 + red];
+        int g = pixels[i * 4 + 1];
+        int b = pixels[i * 4 + blue];
+
+        yPlane[i] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+        cbPlane[i] = ((112 * b - 38 * r - 74 * g + 128 + (128 << 8)) >> 8);
+        crPlane[i] = ((112 * r - 94 * g - 18 * b + 128 + (128 << 8)) >> 8);
+    }
+}
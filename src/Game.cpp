@@ -1,10 +1,14 @@
 #include "Game.hpp"
+#include "Profiler.hpp"
 
 #include <iostream>
 #include <vector>
 #include <chrono>
+#include <algorithm>
 
-Game::Game(int width, int height)
+//Board uses seed and food color uses next one so whole game can be repeated with the same seed
+Game::Game(int width, int height, int boardWidth, int boardHeight, uint64_t seed) : randomEngine(seed + 1),
+    board(DynamicBoardSize(boardWidth, boardHeight), seed), seed(seed), fastForward(false)
 {
     if (width < 0 || height < 0)
     {
@@ -17,13 +21,37 @@ Game::Game(int width, int height)
 
     windowWidth = width;
     windowHeight = height;
+
+    offscreen = false;
 }
 
-bool Game::initGame()
+void Game::setRecordFile(const std::string& fileName)
+{
+    recordFileName = fileName;
+}
+
+void Game::setReplayFile(const std::string& fileName)
+{
+    replayFileName = fileName;
+}
+
+void Game::setRendererOptions(const RendererOptions& rendererOptions)
+{
+    this->rendererOptions = rendererOptions;
+}
+
+void Game::setOffscreen(bool offscreen)
+{
+    this->offscreen = offscreen;
+}
+
+void Game::setScreenshotFile(const std::string& fileName)
 {
-    unsigned timeSeed = std::chrono::system_clock::now().time_since_epoch().count();
-    randomEngine.seed(timeSeed);
+    screenshotFileName = fileName;
+}
 
+bool Game::createWindow()
+{
     if (SDL_Init(SDL_INIT_VIDEO) < 0)
     {
         std::cerr << "SDL Init failed with error: " << SDL_GetError() << std::endl;
@@ -31,7 +59,7 @@ bool Game::initGame()
         return false;
     }
 
-    mainWindow = SDL_CreateWindow("Snake", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, windowWidth, windowHeight, SDL_WINDOW_VULKAN);
+    mainWindow = SDL_CreateWindow("Snake", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, windowWidth, windowHeight, SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE);
 
     if (mainWindow == NULL)
     {
@@ -52,20 +80,65 @@ bool Game::initGame()
         windowHeight = displayMode.h;
     }
 
-    
+    return true;
+}
 
-    if (!vulkanRenderer.initRenderer(mainWindow, windowWidth, windowHeight, ENABLE_DEBUG))
+bool Game::initGame()
+{
+    //Offscreen renderer doesn't use SDL at all, fullscreen size is replaced by 1920x1080
+    if (offscreen)
+    {
+        mainWindow = nullptr;
+
+        if (!windowed)
+        {
+            windowWidth = 1920;
+            windowHeight = 1080;
+        }
+    }
+    else if (!createWindow())
+    {
+        return false;
+    }
+
+    if (!vulkanRenderer.initRenderer(mainWindow, windowWidth, windowHeight, ENABLE_DEBUG, rendererOptions))
     {
         std::cerr << "Vulkan Renderer initialization failed!" << std::endl;
 
         return false;
     }
 
-    board.generateFood();
+    //Replay has its own board size and seed
+    if (!replayFileName.empty())
+    {
+        if (!replayPlayer.load(replayFileName))
+        {
+            std::cerr << "Loading replay " << replayFileName << " failed!" << std::endl;
 
-    snake.setSize(windowWidth / 48, windowHeight / 27); //40x40 on 1920x1080
+            return false;
+        }
 
-    food.setSize(windowWidth / 48, windowHeight / 27);
+        board = replayPlayer.getBoard();
+    }
+    else
+    {
+        board.generateFood();
+
+        replayRecorder.begin(DynamicBoardSize(board.width(), board.height()), seed);
+    }
+
+    //Cells are whole pixels, so every cell needs at least one pixel
+    if (windowWidth / board.width() < 1 || windowHeight / board.height() < 1)
+    {
+        std::cerr << "Board " << board.width() << "x" << board.height() << " doesn't fit to " << windowWidth << "x" << windowHeight
+            << " window!" << std::endl;
+
+        return false;
+    }
+
+    snake.setSize(windowWidth / board.width(), windowHeight / board.height()); //40x40 on 1920x1080 with 48x27 board
+
+    food.setSize(windowWidth / board.width(), windowHeight / board.height());
     food.setPosition(board.foodX * food.width, board.foodY * food.height);
     food.setColor(255, 0, 0);
 
@@ -74,6 +147,14 @@ bool Game::initGame()
 
 int Game::run()
 {
+    //Game needs window for input
+    if (offscreen)
+    {
+        std::cerr << "Offscreen rendering is only supported in benchmark!" << std::endl;
+
+        return EXIT_FAILURE;
+    }
+
     if (!initGame())
     {
         return EXIT_FAILURE;
@@ -81,6 +162,12 @@ int Game::run()
 
     SDL_Event event;
     bool isRunning = true;
+    bool replaying = !replayFileName.empty();
+
+    //Shapes stay in renderer, they are updated only when board changes (every 100ms) instead of every frame
+    snakeHandles.clear();
+    foodHandle = vulkanRenderer.addShape(food);
+    bool sceneChanged = true;
 
     double delta = SDL_GetTicks();
     double previousTime = SDL_GetTicks();
@@ -89,91 +176,372 @@ int Game::run()
     //Main loop
     while(isRunning)
     {
-        while (SDL_PollEvent(&event) != 0)
+        PROFILE_ZONE("Frame");
+
         {
-            if (event.type == SDL_QUIT)
+            PROFILE_ZONE("Events");
+
+            while (SDL_PollEvent(&event) != 0)
+            {
+                if (event.type == SDL_QUIT)
+                {
+                    isRunning = false;
+                }
+
+                //Scene is stretched to new window size
+                if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+                {
+                    vulkanRenderer.resize();
+                }
+
+                //Replay controls, seeking moves by 10 seconds of game
+                if (replaying && event.type == SDL_KEYDOWN)
+                {
+                    switch (event.key.keysym.sym)
+                    {
+                        case SDLK_f:
+                            fastForward = !fastForward;
+                            break;
+
+                        case SDLK_LEFT:
+                            replayPlayer.seek(replayPlayer.getTick() - 100);
+                            sceneChanged = true;
+                            break;
+
+                        case SDLK_RIGHT:
+                            replayPlayer.seek(replayPlayer.getTick() + 100);
+                            sceneChanged = true;
+                            break;
+                    }
+                }
+            }
+        }
+
+        {
+            PROFILE_ZONE("Input");
+
+            const Uint8 *state = SDL_GetKeyboardState(NULL);
+
+            if (!replaying)
+            {
+                if (state[SDL_SCANCODE_UP])
+                {
+                    board.setDirection(Board::Direction::UP);
+                }
+
+                if (state[SDL_SCANCODE_DOWN])
+                {
+                    board.setDirection(Board::Direction::DOWN);
+                }
+
+                if (state[SDL_SCANCODE_LEFT])
+                {
+                    board.setDirection(Board::Direction::LEFT);
+                }
+
+                if (state[SDL_SCANCODE_RIGHT])
+                {
+                    board.setDirection(Board::Direction::RIGHT);
+                }
+            }
+
+            if (state[SDL_SCANCODE_ESCAPE])
             {
                 isRunning = false;
             }
         }
 
-        const Uint8 *state = SDL_GetKeyboardState(NULL);
+        double currentTime = SDL_GetTicks();
+        delta = currentTime - previousTime;
+        previousTime = currentTime;
+        elapsedTime += delta;
 
-        if (state[SDL_SCANCODE_UP])
+        //Make move after every 100ms, finished replay stays on its last tick until it's seeked back
+        if (elapsedTime >= 100 && !(replaying && replayPlayer.isFinished()))
         {
-            board.setDirection(Board::Direction::UP);
+            PROFILE_ZONE("Tick");
+
+            bool moved = true;
+
+            if (replaying)
+            {
+                //Tick where snake died isn't rotated either, scene update then writes every shape which changed
+                moved = replayPlayer.step();
+            }
+            else
+            {
+                //Direction is recorded at the moment of move because it can change many times between moves
+                replayRecorder.addTick(board.getDirection());
+
+                PROFILE_ZONE("Board::moveSnake");
+
+                if (!board.moveSnake())
+                {
+                    isRunning = false;
+                }
+            }
+
+            //Move reuses tail as new head, so handle of tail goes to head too and only this shape is changed
+            if (moved && !snakeHandles.empty())
+            {
+                std::rotate(snakeHandles.begin(), snakeHandles.begin() + 1, snakeHandles.end());
+            }
+            
+            food.setColor(getRandomNumber(32, 255), getRandomNumber(32, 255), getRandomNumber(32, 255));
+            sceneChanged = true;
+
+            elapsedTime = 0;
         }
 
-        if (state[SDL_SCANCODE_DOWN])
+        //Fast forward simulates as many ticks as possible in 10ms of every frame
+        if (replaying && fastForward && !replayPlayer.isFinished())
         {
-            board.setDirection(Board::Direction::DOWN);
+            PROFILE_ZONE("Fast forward");
+
+            Uint32 fastForwardStart = SDL_GetTicks();
+
+            while (SDL_GetTicks() - fastForwardStart < 10 && replayPlayer.step())
+            {
+            }
+
+            sceneChanged = true;
         }
 
-        if (state[SDL_SCANCODE_LEFT])
+        if (!replaying && board.gotFood())
         {
-            board.setDirection(Board::Direction::LEFT);
+            board.addBody();
+
+            //Snake fills whole board
+            if (!board.generateFood())
+            {
+                isRunning = false;
+            }
+
+            sceneChanged = true;
         }
 
-        if (state[SDL_SCANCODE_RIGHT])
+        if (sceneChanged)
         {
-            board.setDirection(Board::Direction::RIGHT);
+            PROFILE_ZONE("Update scene");
+
+            updateScene(replaying ? replayPlayer.getBoard() : board);
+
+            sceneChanged = false;
         }
+        
+        vulkanRenderer.render();
+    }
+
+    printRendererStats();
 
-        if (state[SDL_SCANCODE_ESCAPE])
+    if (!replaying && !recordFileName.empty())
+    {
+        if (!replayRecorder.save(recordFileName))
         {
-            isRunning = false;
+            std::cerr << "Saving replay " << recordFileName << " failed!" << std::endl;
         }
+    }
 
-        double currentTime = SDL_GetTicks();
-        delta = currentTime - previousTime;
-        previousTime = currentTime;
-        elapsedTime += delta;
+    closeGame();
+
+    return EXIT_SUCCESS;
+}
+
+int Game::runBenchmark(int frameCount, bool staticScene)
+{
+    if (!initGame())
+    {
+        return EXIT_FAILURE;
+    }
+
+    SDL_Event event;
+    bool isRunning = true;
 
-        //Make move after every 100ms
-        if (elapsedTime >= 100)
+    std::vector<double> frameTimes;
+    frameTimes.reserve(frameCount);
+
+    //Static scene is the first frame of changing scene, commands can be reused and nothing is uploaded after first frames
+    if (staticScene)
+    {
+        for (int y = 0; y < board.height(); y++)
         {
-            
-            if (!board.moveSnake())
+            for (int x = 0; x < board.width(); x++)
+            {
+                snake.setColor(32 + (x * 8) % 224, 32 + (y * 8) % 224, 32);
+                snake.setPosition(x * snake.width, y * snake.height);
+
+                vulkanRenderer.addShape(snake);
+            }
+        }
+
+        food.setPosition(0, 0);
+        vulkanRenderer.addShape(food);
+    }
+
+    auto previousTime = std::chrono::steady_clock::now();
+
+    //Every cell of board is drawn as snake body so scene is the same as with the longest possible snake
+    for (int frame = 0; frame < frameCount && isRunning; frame++)
+    {
+        while (!offscreen && SDL_PollEvent(&event) != 0)
+        {
+            if (event.type == SDL_QUIT)
             {
                 isRunning = false;
             }
-            
-            food.setColor(getRandomNumber(32, 255), getRandomNumber(32, 255), getRandomNumber(32, 255));
 
-            elapsedTime = 0;
+            if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+            {
+                vulkanRenderer.resize();
+            }
         }
 
-        if (board.gotFood())
+        for (int y = 0; y < board.height() && !staticScene; y++)
         {
-            board.addBody();
-            board.generateFood();
+            for (int x = 0; x < board.width(); x++)
+            {
+                snake.setColor(32 + (x * 8 + frame) % 224, 32 + (y * 8 + frame) % 224, 32 + (frame * 2) % 224);
+                snake.setPosition(x * snake.width, y * snake.height);
+
+                vulkanRenderer.draw(snake);
+            }
         }
 
-        for (SnakeBody snakeBody : board.snake)
+        if (!staticScene)
         {
-            snake.setColor(snakeBody.colorR, snakeBody.colorG, snakeBody.colorB);
-            snake.setPosition(snakeBody.positionX * snake.width, snakeBody.positionY * snake.height);
-
-            vulkanRenderer.draw(snake);
+            food.setPosition((frame % board.width()) * food.width, ((frame / board.width()) % board.height()) * food.height);
+            vulkanRenderer.draw(food);
         }
-        
-        
-        food.setPosition(board.foodX * food.width, board.foodY * food.height);
-        vulkanRenderer.draw(food);
-        
+
         vulkanRenderer.render();
+
+        auto currentTime = std::chrono::steady_clock::now();
+        frameTimes.push_back(std::chrono::duration<double, std::milli>(currentTime - previousTime).count());
+        previousTime = currentTime;
     }
 
+    if (!frameTimes.empty())
+    {
+        std::sort(frameTimes.begin(), frameTimes.end());
+
+        double sum = 0.0;
+
+        for (double frameTime : frameTimes)
+        {
+            sum += frameTime;
+        }
+
+        std::cout << "Benchmark (" << (staticScene ? "static" : "changing") << " scene): " << frameTimes.size() << " frames with " << board.width() * board.height() + 1 << " rectangles, frame time min: "
+            << frameTimes.front() << " ms, avg: " << sum / frameTimes.size() << " ms, p99: " << frameTimes[(frameTimes.size() - 1) * 99 / 100]
+            << " ms" << std::endl;
+    }
+
+    printRendererStats();
+
+    //Last frame is deterministic for given board size and frame count, so it can be compared with reference image
+    bool screenshotSaved = true;
+
+    if (!screenshotFileName.empty())
+    {
+        screenshotSaved = vulkanRenderer.saveImage(screenshotFileName);
+
+        if (!screenshotSaved)
+        {
+            std::cerr << "Saving image " << screenshotFileName << " failed!" << std::endl;
+        }
+    }
+
+    closeGame();
+
+    return screenshotSaved ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+//Bodies are matched with handles by index, renderer ignores updates which don't change shape
+void Game::updateScene(const Board& shownBoard)
+{
+    int snakeSize = shownBoard.snake.size();
+
+    //New bodies are added at tail, replay seek can also make snake shorter
+    while ((int)snakeHandles.size() < snakeSize)
+    {
+        snakeHandles.insert(snakeHandles.begin(), vulkanRenderer.addShape(snake));
+    }
+
+    while ((int)snakeHandles.size() > snakeSize)
+    {
+        vulkanRenderer.removeShape(snakeHandles.front());
+        snakeHandles.erase(snakeHandles.begin());
+    }
+
+    for (int i = 0; i < snakeSize; i++)
+    {
+        const SnakeBody& snakeBody = shownBoard.snake[i];
+
+        snake.setColor(snakeBody.colorR, snakeBody.colorG, snakeBody.colorB);
+        snake.setPosition(snakeBody.positionX * snake.width, snakeBody.positionY * snake.height);
+
+        vulkanRenderer.updateShape(snakeHandles[i], snake);
+    }
+
+    food.setPosition(shownBoard.foodX * food.width, shownBoard.foodY * food.height);
+    vulkanRenderer.updateShape(foodHandle, food);
+}
+
+void Game::closeGame()
+{
     vulkanRenderer.destroyRenderer();
 
-    SDL_DestroyWindow(mainWindow);
+    if (!offscreen)
+    {
+        SDL_DestroyWindow(mainWindow);
 
-    SDL_Quit();
+        SDL_Quit();
+    }
+}
 
-    return EXIT_SUCCESS;
+void Game::printRendererStats()
+{
+    const RendererStats& rendererStats = vulkanRenderer.getStats();
+
+    //Cold start compiles pipeline, warm start loads it from pipeline cache file
+    std::cout << "Renderer init: " << rendererStats.initSeconds * 1000.0 << " ms, pipeline creation: " << rendererStats.pipelineSeconds * 1000.0
+        << " ms (" << (rendererStats.pipelineCacheLoaded ? "warm" : "cold") << " pipeline cache)" << std::endl;
+
+    if (rendererStats.frames > 0)
+    {
+        std::cout << "Rendered " << rendererStats.frames << " frames, CPU time per frame: " << rendererStats.cpuSeconds * 1000.0 / rendererStats.frames
+            << " ms, draw calls per frame: " << (double)rendererStats.drawCalls / rendererStats.frames
+            << ", shapes uploaded per frame: " << (double)rendererStats.uploadedShapes / rendererStats.frames << std::endl;
+
+        //Other frames submitted commands recorded for the same swapchain image before
+        std::cout << "Frames which recorded commands: " << rendererStats.recordedFrames << " of " << rendererStats.frames
+            << (rendererOptions.reuseCommands ? "" : " (command reuse disabled)") << std::endl;
+
+        //Frame pacing, more frames in flight should lower waiting for fences but increase latency
+        std::cout << "Frames in flight: " << rendererOptions.framesInFlight << ", frame time: " << rendererStats.frameSeconds * 1000.0 / rendererStats.frames
+            << " ms, fence wait per frame: " << rendererStats.fenceWaitSeconds * 1000.0 / rendererStats.frames << " ms";
+
+        if (rendererStats.latencySamples > 0)
+        {
+            std::cout << ", submit to finish latency: " << rendererStats.latencySeconds * 1000.0 / rendererStats.latencySamples << " ms";
+        }
+
+        std::cout << std::endl;
+
+        if (rendererStats.gpuSamples > 0)
+        {
+            std::cout << "GPU time per frame: " << rendererStats.gpuSeconds * 1000.0 / rendererStats.gpuSamples << " ms" << std::endl;
+        }
+
+        //Renderer waits only when writer thread can't keep up with frames
+        if (!rendererOptions.captureFileName.empty())
+        {
+            std::cout << "Capture wait for writer per frame: " << rendererStats.captureWaitSeconds * 1000.0 / rendererStats.frames << " ms" << std::endl;
+        }
+    }
 }
 
 int Game::getRandomNumber(int min, int max)
 {
-    return std::uniform_int_distribution<int>{min, max}(randomEngine);
+    return getRandomInRange(randomEngine, min, max);
 }
@@ -0,0 +1,211 @@
+#include "HeadlessGame.hpp"
+#include "Replay.hpp"
+
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+HeadlessGame::HeadlessGame(int boardWidth, int boardHeight, uint64_t seed) : boardSize(boardWidth, boardHeight), seed(seed), board(boardSize, seed)
+{
+}
+
+void HeadlessGame::setScript(const std::string& script)
+{
+    this->script = script;
+}
+
+int HeadlessGame::run(long long ticks)
+{
+    long long games = 1;
+    int longestSnake = board.snake.size();
+
+    board.generateFood();
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    for (long long tick = 0; tick < ticks; tick++)
+    {
+        if (script.empty())
+        {
+            board.setDirection(getBotDirection());
+        }
+        else
+        {
+            board.setDirection(getScriptDirection(tick));
+        }
+
+        bool alive = board.moveSnake();
+
+        if (alive && board.gotFood())
+        {
+            board.addBody();
+
+            if (board.snake.size() > longestSnake)
+            {
+                longestSnake = board.snake.size();
+            }
+
+            //Snake fills whole board
+            alive = board.generateFood();
+        }
+
+        if (!alive)
+        {
+            board = Board(boardSize, seed + games);
+            board.generateFood();
+
+            games++;
+        }
+    }
+
+    auto endTime = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(endTime - startTime).count();
+
+    std::cout << "Board " << board.width() << "x" << board.height() << ": " << ticks << " ticks in " << seconds << " s ("
+        << ticks / seconds << " ticks/s), " << games << " games, longest snake " << longestSnake << std::endl;
+
+    return EXIT_SUCCESS;
+}
+
+int HeadlessGame::playReplay(const std::string& fileName, long long seekTick)
+{
+    ReplayPlayer replayPlayer;
+
+    if (!replayPlayer.load(fileName))
+    {
+        std::cerr << "Loading replay " << fileName << " failed!" << std::endl;
+
+        return EXIT_FAILURE;
+    }
+
+    if (seekTick < 0)
+    {
+        seekTick = replayPlayer.getTickCount();
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    replayPlayer.seek(seekTick);
+
+    auto endTime = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(endTime - startTime).count();
+    const Board& board = replayPlayer.getBoard();
+
+    std::cout << "Replay " << fileName << " (seed " << replayPlayer.getSeed() << ", " << replayPlayer.getTickCount() << " ticks): tick "
+        << replayPlayer.getTick() << " reached in " << seconds << " s, snake length " << board.snake.size() << ", head "
+        << board.snake.head().positionX << "x" << board.snake.head().positionY << ", food " << board.foodX << "x" << board.foodY << std::endl;
+
+    return EXIT_SUCCESS;
+}
+
+Board::Direction HeadlessGame::getScriptDirection(long long tick)
+{
+    switch (script[tick % script.size()])
+    {
+        case 'D':
+            return Board::Direction::DOWN;
+
+        case 'L':
+            return Board::Direction::LEFT;
+
+        case 'R':
+            return Board::Direction::RIGHT;
+
+        default:
+            return Board::Direction::UP;
+    }
+}
+
+//Move towards food on the shortest wrapped path and avoid cells taken by snake
+Board::Direction HeadlessGame::getBotDirection()
+{
+    const SnakeBody& head = board.snake.head();
+
+    int width = board.width();
+    int height = board.height();
+
+    int dx = board.foodX - head.positionX;
+    int dy = board.foodY - head.positionY;
+
+    if (std::abs(dx) > width / 2)
+    {
+        dx = dx > 0 ? dx - width : dx + width;
+    }
+
+    if (std::abs(dy) > height / 2)
+    {
+        dy = dy > 0 ? dy - height : dy + height;
+    }
+
+    Board::Direction preferred[4];
+    int count = 0;
+
+    if (dx != 0)
+    {
+        preferred[count++] = dx > 0 ? Board::Direction::RIGHT : Board::Direction::LEFT;
+    }
+
+    if (dy != 0)
+    {
+        preferred[count++] = dy > 0 ? Board::Direction::DOWN : Board::Direction::UP;
+    }
+
+    preferred[count++] = board.getDirection();
+
+    const Board::Direction all[] = { Board::Direction::UP, Board::Direction::DOWN, Board::Direction::LEFT, Board::Direction::RIGHT };
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (count < 4)
+        {
+            preferred[count++] = all[i];
+        }
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        int x = head.positionX;
+        int y = head.positionY;
+
+        switch (preferred[i])
+        {
+            case Board::Direction::UP:
+                y = (y + height - 1) % height;
+                break;
+
+            case Board::Direction::DOWN:
+                y = (y + 1) % height;
+                break;
+
+            case Board::Direction::LEFT:
+                x = (x + width - 1) % width;
+                break;
+
+            case Board::Direction::RIGHT:
+                x = (x + 1) % width;
+                break;
+        }
+
+        if (isSafe(x, y))
+        {
+            return preferred[i];
+        }
+    }
+
+    return board.getDirection();
+}
+
+//Cell is safe if it's empty or it's tail which will move away
+bool HeadlessGame::isSafe(int x, int y)
+{
+    int segments = board.segmentsAt(x, y);
+
+    if (x == board.snake.tail().positionX && y == board.snake.tail().positionY)
+    {
+        segments--;
+    }
+
+    return segments <= 0;
+}
@@ -0,0 +1,116 @@
+#include "Profiler.hpp"
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+struct ProfileEvent
+{
+    const char* name;
+    long long start, end;
+};
+
+//Ring buffer of one thread, it's owned by registry so zones can be exported after thread finished
+struct ThreadBuffer
+{
+    int threadId;
+    std::vector<ProfileEvent> events;
+    long long count; //All zones added, only last events.size() are kept
+};
+
+static const int threadBufferCapacity = 65536;
+
+static std::mutex registryMutex;
+static std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers;
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+static thread_local ThreadBuffer* threadBuffer = nullptr;
+
+std::atomic<bool> Profiler::enabled(false);
+
+void Profiler::setEnabled(bool enabled)
+{
+    Profiler::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+long long Profiler::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void Profiler::addZone(const char* name, long long start, long long end)
+{
+    //Lock is taken only once per thread to register its buffer
+    if (threadBuffer == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+
+        threadBuffers.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer()));
+
+        threadBuffer = threadBuffers.back().get();
+        threadBuffer->threadId = threadBuffers.size() - 1;
+        threadBuffer->events.resize(threadBufferCapacity);
+        threadBuffer->count = 0;
+    }
+
+    ProfileEvent& event = threadBuffer->events[threadBuffer->count % threadBufferCapacity];
+    event.name = name;
+    event.start = start;
+    event.end = end;
+
+    threadBuffer->count++;
+}
+
+//Complete events ("ph":"X") with times in microseconds
+bool Profiler::exportChromeTrace(const std::string& fileName)
+{
+    std::ofstream traceFile(fileName);
+
+    if (!traceFile.is_open())
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    traceFile << std::fixed << std::setprecision(3);
+    traceFile << "{\"traceEvents\":[";
+
+    bool first = true;
+
+    for (const std::unique_ptr<ThreadBuffer>& buffer : threadBuffers)
+    {
+        long long firstEvent = buffer->count > threadBufferCapacity ? buffer->count - threadBufferCapacity : 0;
+
+        for (long long i = firstEvent; i < buffer->count; i++)
+        {
+            const ProfileEvent& event = buffer->events[i % threadBufferCapacity];
+
+            traceFile << (first ? "\n" : ",\n");
+            traceFile << "{\"name\":\"";
+
+            for (const char* c = event.name; *c != '\0'; c++)
+            {
+                if (*c == '"' || *c == '\\')
+                {
+                    traceFile << '\\';
+                }
+
+                traceFile << *c;
+            }
+
+            traceFile << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"ts\":" << event.start / 1000.0
+                << ",\"dur\":" << (event.end - event.start) / 1000.0 << "}";
+
+            first = false;
+        }
+    }
+
+    traceFile << "\n]}\n";
+
+    return traceFile.good();
+}
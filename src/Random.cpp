@@ -0,0 +1,23 @@
+#include "Random.hpp"
+
+Xoshiro128::Xoshiro128(uint64_t seed)
+{
+    this->seed(seed);
+}
+
+//State is filled with splitmix64 as recommended by xoshiro authors
+void Xoshiro128::seed(uint64_t seed)
+{
+    for (int i = 0; i < 4; i += 2)
+    {
+        seed += 0x9E3779B97F4A7C15ull;
+
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z = z ^ (z >> 31);
+
+        state[i] = (uint32_t)z;
+        state[i + 1] = (uint32_t)(z >> 32);
+    }
+}
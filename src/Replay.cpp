@@ -0,0 +1,272 @@
+#include "Replay.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+
+static const char replayMagic[4] = { 'V', 'K', 'S', 'R' };
+static const unsigned char replayVersion = 1;
+
+//Limits for values read from file, so broken file can't make board with overflowed size or allocate too much memory
+static const uint64_t maxReplayCells = 65536;
+static const uint64_t maxReplayTicks = 100000000; //About 115 days of game, one byte per tick in memory
+
+//7 bits per byte, highest bit set when more bytes follow
+static void writeVarint(std::vector<unsigned char>& data, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        data.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+
+    data.push_back((unsigned char)value);
+}
+
+static bool readVarint(const std::vector<unsigned char>& data, size_t& position, uint64_t& value)
+{
+    value = 0;
+
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (position >= data.size())
+        {
+            return false;
+        }
+
+        unsigned char byte = data[position++];
+        value |= (uint64_t)(byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ReplayRecorder::begin(DynamicBoardSize boardSize, uint64_t seed)
+{
+    this->boardSize = boardSize;
+    this->seed = seed;
+    tickCount = 0;
+
+    runs.clear();
+}
+
+void ReplayRecorder::addTick(int direction)
+{
+    //Extend current run or start new one
+    if (!runs.empty() && (int)(runs.back() & 3) == direction)
+    {
+        runs.back() += 4;
+    }
+    else
+    {
+        runs.push_back((1 << 2) | direction);
+    }
+
+    tickCount++;
+}
+
+bool ReplayRecorder::save(const std::string& fileName)
+{
+    std::vector<unsigned char> data(replayMagic, replayMagic + 4);
+    data.push_back(replayVersion);
+
+    writeVarint(data, boardSize.width());
+    writeVarint(data, boardSize.height());
+    writeVarint(data, seed);
+    writeVarint(data, tickCount);
+    writeVarint(data, runs.size());
+
+    for (uint64_t run : runs)
+    {
+        writeVarint(data, run);
+    }
+
+    std::ofstream replayFile(fileName, std::ios::binary);
+
+    if (!replayFile.is_open())
+    {
+        return false;
+    }
+
+    replayFile.write((const char*)data.data(), data.size());
+
+    return replayFile.good();
+}
+
+long long ReplayRecorder::getTickCount() const
+{
+    return tickCount;
+}
+
+ReplayPlayer::ReplayPlayer() : seed(0), tick(0), finished(true), snapshotInterval(1000)
+{
+}
+
+bool ReplayPlayer::load(const std::string& fileName)
+{
+    std::ifstream replayFile(fileName, std::ios::binary);
+
+    if (!replayFile.is_open())
+    {
+        return false;
+    }
+
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(replayFile)), std::istreambuf_iterator<char>());
+
+    if (data.size() < 5 || !std::equal(replayMagic, replayMagic + 4, data.begin()) || data[4] != replayVersion)
+    {
+        return false;
+    }
+
+    size_t position = 5;
+    uint64_t width, height, tickCount, runCount;
+
+    if (!readVarint(data, position, width) || !readVarint(data, position, height) || !readVarint(data, position, seed)
+        || !readVarint(data, position, tickCount) || !readVarint(data, position, runCount))
+    {
+        return false;
+    }
+
+    //Each size is checked alone first, so their product can't overflow
+    if (width < 2 || height < 2 || width > maxReplayCells || height > maxReplayCells || width * height > maxReplayCells)
+    {
+        return false;
+    }
+
+    if (tickCount > maxReplayTicks)
+    {
+        return false;
+    }
+
+    directions.clear();
+    directions.reserve(tickCount);
+
+    for (uint64_t i = 0; i < runCount; i++)
+    {
+        uint64_t run;
+
+        if (!readVarint(data, position, run) || directions.size() + (run >> 2) > tickCount)
+        {
+            return false;
+        }
+
+        directions.insert(directions.end(), run >> 2, run & 3);
+    }
+
+    if (directions.size() != tickCount)
+    {
+        return false;
+    }
+
+    boardSize = DynamicBoardSize(width, height);
+
+    restart();
+
+    return true;
+}
+
+void ReplayPlayer::setSnapshotInterval(int ticks)
+{
+    snapshotInterval = ticks > 0 ? ticks : 1;
+}
+
+//Same order as tick in Game::run()
+bool ReplayPlayer::step()
+{
+    if (finished)
+    {
+        return false;
+    }
+
+    board.forceDirection((Board::Direction)directions[tick]);
+
+    bool alive = board.moveSnake();
+
+    if (alive && board.gotFood())
+    {
+        board.addBody();
+        alive = board.generateFood();
+    }
+
+    tick++;
+
+    //Snapshots are made when tick is reached first time, never for dead snake
+    if (alive && tick % snapshotInterval == 0 && tick / snapshotInterval == (long long)snapshots.size())
+    {
+        snapshots.push_back(board);
+    }
+
+    finished = !alive || tick == (long long)directions.size();
+
+    return alive;
+}
+
+void ReplayPlayer::seek(long long tick)
+{
+    if (tick < 0)
+    {
+        tick = 0;
+    }
+
+    if (tick > (long long)directions.size())
+    {
+        tick = directions.size();
+    }
+
+    //Jump to nearest snapshot if it's before target and closer than current tick
+    long long snapshot = std::min(tick / snapshotInterval, (long long)snapshots.size() - 1);
+
+    if (tick < this->tick || snapshot * snapshotInterval > this->tick)
+    {
+        board = snapshots[snapshot];
+        this->tick = snapshot * snapshotInterval;
+        finished = this->tick == (long long)directions.size();
+    }
+
+    while (this->tick < tick && step())
+    {
+    }
+}
+
+long long ReplayPlayer::getTick() const
+{
+    return tick;
+}
+
+long long ReplayPlayer::getTickCount() const
+{
+    return directions.size();
+}
+
+bool ReplayPlayer::isFinished() const
+{
+    return finished;
+}
+
+uint64_t ReplayPlayer::getSeed() const
+{
+    return seed;
+}
+
+const Board& ReplayPlayer::getBoard() const
+{
+    return board;
+}
+
+//Board is created the same way as in Game::initGame()
+void ReplayPlayer::restart()
+{
+    board = Board(boardSize, seed);
+    board.generateFood();
+
+    tick = 0;
+    finished = directions.empty();
+
+    snapshots.clear();
+    snapshots.push_back(board);
+}
@@ -0,0 +1,120 @@
+#include "SnakeBuffer.hpp"
+
+SnakeBuffer::SnakeBuffer(int capacity) : bodies(capacity), start(0), count(0)
+{
+}
+
+int SnakeBuffer::size() const
+{
+    return count;
+}
+
+int SnakeBuffer::capacity() const
+{
+    return bodies.size();
+}
+
+bool SnakeBuffer::empty() const
+{
+    return count == 0;
+}
+
+bool SnakeBuffer::full() const
+{
+    return count == (int)bodies.size();
+}
+
+const SnakeBody& SnakeBuffer::operator[](int index) const
+{
+    return bodies[physicalIndex(index)];
+}
+
+SnakeBody& SnakeBuffer::operator[](int index)
+{
+    return bodies[physicalIndex(index)];
+}
+
+const SnakeBody& SnakeBuffer::head() const
+{
+    return bodies[physicalIndex(count - 1)];
+}
+
+const SnakeBody& SnakeBuffer::tail() const
+{
+    return bodies[start];
+}
+
+//Add new head after last element
+bool SnakeBuffer::pushHead(const SnakeBody& body)
+{
+    if (full())
+    {
+        return false;
+    }
+
+    bodies[physicalIndex(count)] = body;
+    count++;
+
+    return true;
+}
+
+//Add new tail before first element
+bool SnakeBuffer::pushTail(const SnakeBody& body)
+{
+    if (full())
+    {
+        return false;
+    }
+
+    start = (start == 0) ? bodies.size() - 1 : start - 1;
+    bodies[start] = body;
+    count++;
+
+    return true;
+}
+
+//Remove and return first element, buffer can't be empty
+SnakeBody SnakeBuffer::popTail()
+{
+    SnakeBody body = bodies[start];
+
+    start++;
+
+    if (start == (int)bodies.size())
+    {
+        start = 0;
+    }
+
+    count--;
+
+    return body;
+}
+
+void SnakeBuffer::clear()
+{
+    start = 0;
+    count = 0;
+}
+
+SnakeBuffer::Iterator SnakeBuffer::begin() const
+{
+    return Iterator(this, 0);
+}
+
+SnakeBuffer::Iterator SnakeBuffer::end() const
+{
+    return Iterator(this, count);
+}
+
+//Map logical index to index in storage without modulo
+int SnakeBuffer::physicalIndex(int index) const
+{
+    int physical = start + index;
+
+    if (physical >= (int)bodies.size())
+    {
+        physical -= bodies.size();
+    }
+
+    return physical;
+}
@@ -0,0 +1,34 @@
+#include "EmbeddedShaders.hpp"
+
+#include <cstring>
+
+//Generated files have comma separated SPIR-V words, see shader rules in Makefile
+static const uint32_t vertexShaderCode[] =
+{
+#include "../shaders/vertexshader.vert.inc"
+};
+
+static const uint32_t fragmentShaderCode[] =
+{
+#include "../shaders/fragmentshader.frag.inc"
+};
+
+bool EmbeddedShaders::getShader(const char* name, const uint32_t*& code, size_t& codeSize)
+{
+    if (strcmp(name, "vertexshader") == 0)
+    {
+        code = vertexShaderCode;
+        codeSize = sizeof(vertexShaderCode);
+    }
+    else if (strcmp(name, "fragmentshader") == 0)
+    {
+        code = fragmentShaderCode;
+        codeSize = sizeof(fragmentShaderCode);
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
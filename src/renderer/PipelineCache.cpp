@@ -0,0 +1,163 @@
+#include "PipelineCache.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+
+static const char pipelineCacheMagic[4] = { 'V', 'K', 'S', 'P' };
+static const uint32_t pipelineCacheVersion = 1;
+static const size_t pipelineCacheHeaderSize = 12; //Magic, version and data size
+
+PipelineCache::PipelineCache() : device(VK_NULL_HANDLE), pipelineCache(VK_NULL_HANDLE), loaded(false)
+{
+}
+
+bool PipelineCache::create(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& fileName)
+{
+    this->device = device;
+    this->fileName = fileName;
+
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    loaded = false;
+
+    std::vector<unsigned char> fileData;
+
+    if (!fileName.empty())
+    {
+        std::ifstream cacheFile(fileName, std::ios::binary);
+
+        if (cacheFile.is_open())
+        {
+            fileData.assign(std::istreambuf_iterator<char>(cacheFile), std::istreambuf_iterator<char>());
+        }
+    }
+
+    VkPipelineCacheCreateInfo pipelineCacheInfo = {};
+    pipelineCacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    pipelineCacheInfo.pNext = nullptr;
+    pipelineCacheInfo.flags = 0;
+
+    if (fileData.size() >= pipelineCacheHeaderSize && memcmp(fileData.data(), pipelineCacheMagic, 4) == 0)
+    {
+        uint32_t version, dataSize;
+        memcpy(&version, fileData.data() + 4, 4);
+        memcpy(&dataSize, fileData.data() + 8, 4);
+
+        const unsigned char* data = fileData.data() + pipelineCacheHeaderSize;
+
+        if (version == pipelineCacheVersion && dataSize == fileData.size() - pipelineCacheHeaderSize && isCompatible(data, dataSize))
+        {
+            pipelineCacheInfo.initialDataSize = dataSize;
+            pipelineCacheInfo.pInitialData = data;
+
+            loaded = true;
+        }
+    }
+
+    if (vkCreatePipelineCache(device, &pipelineCacheInfo, nullptr, &pipelineCache) != VK_SUCCESS)
+    {
+        loaded = false;
+
+        //Driver can still reject data, empty cache is better than none
+        pipelineCacheInfo.initialDataSize = 0;
+        pipelineCacheInfo.pInitialData = nullptr;
+
+        if (vkCreatePipelineCache(device, &pipelineCacheInfo, nullptr, &pipelineCache) != VK_SUCCESS)
+        {
+            pipelineCache = VK_NULL_HANDLE;
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void PipelineCache::destroy()
+{
+    if (pipelineCache != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineCache(device, pipelineCache, nullptr);
+    }
+
+    pipelineCache = VK_NULL_HANDLE;
+}
+
+bool PipelineCache::save()
+{
+    if (pipelineCache == VK_NULL_HANDLE || fileName.empty())
+    {
+        return false;
+    }
+
+    size_t dataSize = 0;
+
+    if (vkGetPipelineCacheData(device, pipelineCache, &dataSize, nullptr) != VK_SUCCESS)
+    {
+        return false;
+    }
+
+    std::vector<unsigned char> data(pipelineCacheHeaderSize + dataSize);
+
+    if (vkGetPipelineCacheData(device, pipelineCache, &dataSize, data.data() + pipelineCacheHeaderSize) != VK_SUCCESS)
+    {
+        return false;
+    }
+
+    uint32_t storedDataSize = dataSize;
+
+    memcpy(data.data(), pipelineCacheMagic, 4);
+    memcpy(data.data() + 4, &pipelineCacheVersion, 4);
+    memcpy(data.data() + 8, &storedDataSize, 4);
+
+    std::string temporaryFileName = fileName + ".tmp";
+
+    {
+        std::ofstream cacheFile(temporaryFileName, std::ios::binary);
+
+        if (!cacheFile.is_open())
+        {
+            return false;
+        }
+
+        cacheFile.write((const char*)data.data(), pipelineCacheHeaderSize + dataSize);
+
+        if (!cacheFile.good())
+        {
+            return false;
+        }
+    }
+
+    return std::rename(temporaryFileName.c_str(), fileName.c_str()) == 0;
+}
+
+VkPipelineCache PipelineCache::getPipelineCache() const
+{
+    return pipelineCache;
+}
+
+bool PipelineCache::isLoaded() const
+{
+    return loaded;
+}
+
+//Header written by driver (VkPipelineCacheHeaderVersionOne): header size, header version, vendor ID, device ID, cache UUID
+bool PipelineCache::isCompatible(const unsigned char* data, size_t size)
+{
+    if (size < 16 + VK_UUID_SIZE)
+    {
+        return false;
+    }
+
+    uint32_t headerSize, headerVersion, vendorID, deviceID;
+    memcpy(&headerSize, data, 4);
+    memcpy(&headerVersion, data + 4, 4);
+    memcpy(&vendorID, data + 8, 4);
+    memcpy(&deviceID, data + 12, 4);
+
+    return headerSize >= 16 + VK_UUID_SIZE && headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE && vendorID == properties.vendorID
+        && deviceID == properties.deviceID && memcmp(data + 16, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
@@ -0,0 +1,276 @@
+#include "ShaderReloader.hpp"
+
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/wait.h>
+
+ShaderReloader::ShaderReloader() : device(VK_NULL_HANDLE), inotifyDescriptor(-1), stopping(false), ready(false)
+{
+}
+
+ShaderReloader::~ShaderReloader()
+{
+    stop();
+}
+
+//Editors often save by writing new file and renaming it, so both close after write and move are watched
+bool ShaderReloader::start(VkDevice device, const std::string& directory, const std::vector<std::string>& fileNames, Builder builder)
+{
+    stop();
+
+    this->device = device;
+    this->directory = directory;
+    this->fileNames = fileNames;
+    this->builder = builder;
+
+    inotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (inotifyDescriptor < 0)
+    {
+        return false;
+    }
+
+    if (inotify_add_watch(inotifyDescriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        close(inotifyDescriptor);
+        inotifyDescriptor = -1;
+
+        return false;
+    }
+
+    stopping = false;
+    watcherThread = std::thread(&ShaderReloader::watcherLoop, this);
+
+    return true;
+}
+
+void ShaderReloader::stop()
+{
+    if (!watcherThread.joinable())
+    {
+        return;
+    }
+
+    stopping = true;
+    watcherThread.join();
+
+    close(inotifyDescriptor);
+    inotifyDescriptor = -1;
+
+    if (ready)
+    {
+        destroyPipeline(device, readyPipeline);
+        ready = false;
+    }
+}
+
+bool ShaderReloader::isRunning() const
+{
+    return watcherThread.joinable();
+}
+
+//Watcher thread holds mutex only while it stores finished pipeline, but render thread doesn't wait even for that
+bool ShaderReloader::takePipeline(ReloadedPipeline& pipeline)
+{
+    std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+
+    if (!lock.owns_lock() || !ready)
+    {
+        return false;
+    }
+
+    pipeline = readyPipeline;
+    ready = false;
+
+    return true;
+}
+
+void ShaderReloader::destroyPipeline(VkDevice device, ReloadedPipeline& pipeline)
+{
+    pipeline.pipeline.destroyPipeline(device);
+
+    for (VkShaderModule shaderModule : pipeline.shaderModules)
+    {
+        vkDestroyShaderModule(device, shaderModule, nullptr);
+    }
+
+    pipeline.shaderModules.clear();
+}
+
+void ShaderReloader::watcherLoop()
+{
+    while (!stopping)
+    {
+        //Timeout only lets thread notice stop()
+        if (!waitForChange(100))
+        {
+            continue;
+        }
+
+        //Saving can produce more events, compile after file was quiet for a while
+        while (!stopping && waitForChange(100))
+        {
+        }
+
+        if (stopping)
+        {
+            break;
+        }
+
+        std::vector<std::vector<uint32_t>> shaderCode(fileNames.size());
+        bool compiled = true;
+
+        for (int i = 0; i < (int)fileNames.size() && compiled; i++)
+        {
+            compiled = compileShader(directory + "/" + fileNames[i], shaderCode[i]);
+        }
+
+        ReloadedPipeline pipeline;
+
+        if (!compiled || !builder(shaderCode, pipeline))
+        {
+            std::cerr << "Reloading shaders failed, current pipeline is kept" << std::endl;
+
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            //Renderer didn't take previous pipeline yet, so it was never used by GPU
+            if (ready)
+            {
+                destroyPipeline(device, readyPipeline);
+            }
+
+            readyPipeline = pipeline;
+            ready = true;
+        }
+
+        std::cout << "Shaders reloaded" << std::endl;
+    }
+}
+
+bool ShaderReloader::waitForChange(int timeoutMilliseconds)
+{
+    pollfd pollDescriptor = {};
+    pollDescriptor.fd = inotifyDescriptor;
+    pollDescriptor.events = POLLIN;
+
+    if (poll(&pollDescriptor, 1, timeoutMilliseconds) <= 0)
+    {
+        return false;
+    }
+
+    bool changed = false;
+
+    //Events have variable length (name follows header), buffer is aligned for their headers
+    alignas(inotify_event) char eventData[4096];
+    ssize_t dataSize;
+
+    while ((dataSize = read(inotifyDescriptor, eventData, sizeof(eventData))) > 0)
+    {
+        for (ssize_t offset = 0; offset < dataSize; )
+        {
+            const inotify_event* event = (const inotify_event*)(eventData + offset);
+
+            for (const std::string& fileName : fileNames)
+            {
+                if (event->len > 0 && fileName == event->name)
+                {
+                    changed = true;
+                }
+            }
+
+            offset += sizeof(inotify_event) + event->len;
+        }
+    }
+
+    return changed;
+}
+
+//glslc writes SPIR-V to standard output, so there are no temporary files, its errors go to standard error
+//It's started without shell, so any characters in shader directory are safe
+bool ShaderReloader::compileShader(const std::string& fileName, std::vector<uint32_t>& code)
+{
+    //Path starting with dash would be taken as option
+    std::string inputFileName = fileName[0] == '-' ? "./" + fileName : fileName;
+
+    //Everything child needs is prepared before fork, other threads can hold locks of allocator
+    const char* arguments[] = { "glslc", "-o", "-", inputFileName.c_str(), nullptr };
+
+    int outputPipe[2];
+
+    if (pipe(outputPipe) != 0)
+    {
+        return false;
+    }
+
+    pid_t compilerProcess = fork();
+
+    if (compilerProcess < 0)
+    {
+        close(outputPipe[0]);
+        close(outputPipe[1]);
+
+        return false;
+    }
+
+    if (compilerProcess == 0)
+    {
+        dup2(outputPipe[1], STDOUT_FILENO);
+        close(outputPipe[0]);
+        close(outputPipe[1]);
+
+        execvp(arguments[0], (char* const*)arguments);
+
+        _exit(127);
+    }
+
+    close(outputPipe[1]);
+
+    std::vector<unsigned char> data;
+    unsigned char buffer[4096];
+    ssize_t readSize;
+
+    while ((readSize = read(outputPipe[0], buffer, sizeof(buffer))) != 0)
+    {
+        if (readSize < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            break;
+        }
+
+        data.insert(data.end(), buffer, buffer + readSize);
+    }
+
+    close(outputPipe[0]);
+
+    int status;
+
+    while (waitpid(compilerProcess, &status, 0) < 0)
+    {
+        if (errno != EINTR)
+        {
+            return false;
+        }
+    }
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || data.empty() || data.size() % 4 != 0)
+    {
+        return false;
+    }
+
+    code.resize(data.size() / 4);
+    memcpy(code.data(), data.data(), data.size());
+
+    return true;
+}
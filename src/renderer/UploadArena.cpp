@@ -0,0 +1,121 @@
+#include "UploadArena.hpp"
+
+UploadArena::UploadArena() : allocator(VK_NULL_HANDLE), usage(0), buffer(VK_NULL_HANDLE), allocation(VK_NULL_HANDLE), mappedData(nullptr), size(0), offset(0), generation(0)
+{
+}
+
+//Buffer is created with mapped bit so VMA keeps it mapped until it's destroyed
+bool UploadArena::create(VmaAllocator allocator, VkDeviceSize size, VkBufferUsageFlags usage)
+{
+    this->allocator = allocator;
+    this->usage = usage;
+
+    generation++;
+
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+
+    VmaAllocationCreateInfo vmaAllocationInfo = {};
+    vmaAllocationInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    vmaAllocationInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    VmaAllocationInfo allocationInfo;
+
+    if (vmaCreateBuffer(allocator, &bufferInfo, &vmaAllocationInfo, &buffer, &allocation, &allocationInfo) != VK_SUCCESS)
+    {
+        buffer = VK_NULL_HANDLE;
+        allocation = VK_NULL_HANDLE;
+        mappedData = nullptr;
+        this->size = 0;
+
+        return false;
+    }
+
+    mappedData = (unsigned char*)allocationInfo.pMappedData;
+    this->size = size;
+    offset = 0;
+
+    return true;
+}
+
+void UploadArena::destroy()
+{
+    if (buffer != VK_NULL_HANDLE)
+    {
+        vmaDestroyBuffer(allocator, buffer, allocation);
+    }
+
+    buffer = VK_NULL_HANDLE;
+    allocation = VK_NULL_HANDLE;
+    mappedData = nullptr;
+    size = 0;
+    offset = 0;
+}
+
+bool UploadArena::reset(VkDeviceSize requiredSize)
+{
+    offset = 0;
+
+    if (requiredSize <= size)
+    {
+        return true;
+    }
+
+    //Grow to double of needed size so buffer isn't recreated every time scene gets a bit bigger
+    VkDeviceSize newSize = size;
+
+    while (newSize < requiredSize)
+    {
+        newSize = newSize > 0 ? newSize * 2 : requiredSize;
+    }
+
+    destroy();
+
+    return create(allocator, newSize, usage);
+}
+
+void* UploadArena::allocate(VkDeviceSize dataSize, VkDeviceSize alignment, VkDeviceSize& dataOffset)
+{
+    VkDeviceSize alignedOffset = alignment > 1 ? (offset + alignment - 1) / alignment * alignment : offset;
+
+    if (mappedData == nullptr || alignedOffset + dataSize > size)
+    {
+        return nullptr;
+    }
+
+    dataOffset = alignedOffset;
+    offset = alignedOffset + dataSize;
+
+    return mappedData + alignedOffset;
+}
+
+//Only used part is flushed, VMA skips it when memory type is host coherent
+void UploadArena::flush()
+{
+    if (offset > 0)
+    {
+        vmaFlushAllocation(allocator, allocation, 0, offset);
+    }
+}
+
+VkBuffer UploadArena::getBuffer() const
+{
+    return buffer;
+}
+
+VkDeviceSize UploadArena::getSize() const
+{
+    return size;
+}
+
+VkDeviceSize UploadArena::getUsedSize() const
+{
+    return offset;
+}
+
+unsigned long long UploadArena::getGeneration() const
+{
+    return generation;
+}
@@ -0,0 +1,323 @@
+#include "UploadManager.hpp"
+
+#include <cstring>
+
+UploadManager::UploadManager() : device(VK_NULL_HANDLE), allocator(VK_NULL_HANDLE), transferQueue(VK_NULL_HANDLE), dedicatedTransfer(false),
+    commandPool(VK_NULL_HANDLE), recording(false)
+{
+}
+
+bool UploadManager::init(VkDevice device, VmaAllocator allocator, uint32_t graphicsQueueFamily, VkQueue transferQueue, uint32_t transferQueueFamily)
+{
+    this->device = device;
+    this->allocator = allocator;
+    this->graphicsQueueFamily = graphicsQueueFamily;
+    this->transferQueue = transferQueue;
+    this->transferQueueFamily = transferQueueFamily;
+
+    dedicatedTransfer = transferQueueFamily != graphicsQueueFamily;
+    recording = false;
+
+    VkCommandPoolCreateInfo commandPoolInfo = {};
+    commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    commandPoolInfo.pNext = nullptr;
+    commandPoolInfo.queueFamilyIndex = transferQueueFamily;
+    commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+    return vkCreateCommandPool(device, &commandPoolInfo, nullptr, &commandPool) == VK_SUCCESS;
+}
+
+void UploadManager::destroy()
+{
+    if (recording)
+    {
+        destroyBatch(recordingBatch);
+
+        recording = false;
+    }
+
+    for (UploadBatch& batch : submittedBatches)
+    {
+        destroyBatch(batch);
+    }
+
+    submittedBatches.clear();
+
+    vkDestroyCommandPool(device, commandPool, nullptr);
+}
+
+//Uploaded buffers are expected to be read by vertex input (vertex and index buffers)
+bool UploadManager::uploadBuffer(const void* data, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer& buffer, VmaAllocation& allocation)
+{
+    if (!recording && !beginBatch())
+    {
+        return false;
+    }
+
+    //Staging buffer stays mapped until batch is finished
+    VkBufferCreateInfo stagingBufferInfo = {};
+    stagingBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    stagingBufferInfo.size = size;
+    stagingBufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+    VmaAllocationCreateInfo stagingAllocationInfo = {};
+    stagingAllocationInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+    stagingAllocationInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    StagingBuffer staging;
+    VmaAllocationInfo allocationInfo;
+
+    if (vmaCreateBuffer(allocator, &stagingBufferInfo, &stagingAllocationInfo, &staging.buffer, &staging.allocation, &allocationInfo) != VK_SUCCESS)
+    {
+        return false;
+    }
+
+    memcpy(allocationInfo.pMappedData, data, size);
+    vmaFlushAllocation(allocator, staging.allocation, 0, VK_WHOLE_SIZE);
+
+    //Device local buffer is owned by queue family which copies to it
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo vmaAllocationInfo = {};
+    vmaAllocationInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    if (vmaCreateBuffer(allocator, &bufferInfo, &vmaAllocationInfo, &buffer, &allocation, nullptr) != VK_SUCCESS)
+    {
+        vmaDestroyBuffer(allocator, staging.buffer, staging.allocation);
+
+        return false;
+    }
+
+    recordingBatch.stagingBuffers.push_back(staging);
+
+    VkBufferCopy copyRegion = {};
+    copyRegion.srcOffset = 0;
+    copyRegion.dstOffset = 0;
+    copyRegion.size = size;
+
+    vkCmdCopyBuffer(recordingBatch.commandBuffer, staging.buffer, buffer, 1, &copyRegion);
+
+    //Barrier is the same for both queues, only access masks differ (see submit and acquireUploads)
+    VkBufferMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.pNext = nullptr;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+    barrier.srcQueueFamilyIndex = dedicatedTransfer ? transferQueueFamily : VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = dedicatedTransfer ? graphicsQueueFamily : VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = buffer;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+
+    recordingBatch.acquireBarriers.push_back(barrier);
+
+    return true;
+}
+
+bool UploadManager::submit()
+{
+    if (!recording)
+    {
+        return true;
+    }
+
+    recording = false;
+
+    UploadBatch& batch = recordingBatch;
+    std::vector<VkBufferMemoryBarrier> releaseBarriers = batch.acquireBarriers;
+
+    if (dedicatedTransfer)
+    {
+        //Release part of ownership transfer, writes only have to be available, graphics queue makes them visible
+        for (VkBufferMemoryBarrier& barrier : releaseBarriers)
+        {
+            barrier.dstAccessMask = 0;
+        }
+
+        vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr,
+            releaseBarriers.size(), releaseBarriers.data(), 0, nullptr);
+    }
+    else
+    {
+        //The same queue, barrier also covers frames submitted later
+        vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 0, nullptr,
+            releaseBarriers.size(), releaseBarriers.data(), 0, nullptr);
+
+        batch.acquireBarriers.clear();
+    }
+
+    vkEndCommandBuffer(batch.commandBuffer);
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = nullptr;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &batch.commandBuffer;
+    submitInfo.signalSemaphoreCount = dedicatedTransfer ? 1 : 0;
+    submitInfo.pSignalSemaphores = &batch.semaphore;
+
+    if (vkQueueSubmit(transferQueue, 1, &submitInfo, batch.fence) != VK_SUCCESS)
+    {
+        destroyBatch(batch);
+
+        return false;
+    }
+
+    //Batch on graphics queue doesn't need acquire, it's freed as soon as its fence is signaled
+    batch.needsAcquire = dedicatedTransfer;
+
+    submittedBatches.push_back(batch);
+
+    return true;
+}
+
+void UploadManager::acquireUploads(VkCommandBuffer commandBuffer, long long frameNumber, std::vector<VkSemaphore>& waitSemaphores, std::vector<VkPipelineStageFlags>& waitStages)
+{
+    std::vector<VkBufferMemoryBarrier> barriers;
+
+    for (UploadBatch& batch : submittedBatches)
+    {
+        if (!batch.needsAcquire || batch.acquireFrame >= 0)
+        {
+            continue;
+        }
+
+        for (VkBufferMemoryBarrier barrier : batch.acquireBarriers)
+        {
+            barrier.srcAccessMask = 0;
+            barriers.push_back(barrier);
+        }
+
+        waitSemaphores.push_back(batch.semaphore);
+        waitStages.push_back(VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+
+        batch.acquireFrame = frameNumber;
+    }
+
+    //Source stage is the same as wait stage of semaphore so acquire happens after semaphore wait
+    if (!barriers.empty())
+    {
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 0, nullptr,
+            barriers.size(), barriers.data(), 0, nullptr);
+    }
+}
+
+bool UploadManager::hasUploadsToAcquire() const
+{
+    for (const UploadBatch& batch : submittedBatches)
+    {
+        if (batch.needsAcquire && batch.acquireFrame < 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//Semaphore of batch can be destroyed only after frame which waited for it is finished
+void UploadManager::collectFinished(long long finishedFrame)
+{
+    for (int i = 0; i < (int)submittedBatches.size(); i++)
+    {
+        UploadBatch& batch = submittedBatches[i];
+
+        bool acquireFinished = !batch.needsAcquire || (batch.acquireFrame >= 0 && batch.acquireFrame <= finishedFrame);
+
+        if (!acquireFinished || vkGetFenceStatus(device, batch.fence) != VK_SUCCESS)
+        {
+            continue;
+        }
+
+        destroyBatch(batch);
+
+        submittedBatches.erase(submittedBatches.begin() + i);
+        i--;
+    }
+}
+
+bool UploadManager::hasDedicatedTransferQueue() const
+{
+    return dedicatedTransfer;
+}
+
+bool UploadManager::beginBatch()
+{
+    recordingBatch = UploadBatch();
+    recordingBatch.commandBuffer = VK_NULL_HANDLE;
+    recordingBatch.fence = VK_NULL_HANDLE;
+    recordingBatch.semaphore = VK_NULL_HANDLE;
+    recordingBatch.needsAcquire = false;
+    recordingBatch.acquireFrame = -1;
+
+    VkCommandBufferAllocateInfo commandBufferAllocateInfo = {};
+    commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    commandBufferAllocateInfo.pNext = nullptr;
+    commandBufferAllocateInfo.commandPool = commandPool;
+    commandBufferAllocateInfo.commandBufferCount = 1;
+    commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+
+    VkFenceCreateInfo fenceCreateInfo = {};
+    fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceCreateInfo.pNext = nullptr;
+    fenceCreateInfo.flags = 0;
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreCreateInfo.pNext = nullptr;
+    semaphoreCreateInfo.flags = 0;
+
+    if (vkAllocateCommandBuffers(device, &commandBufferAllocateInfo, &recordingBatch.commandBuffer) != VK_SUCCESS
+        || vkCreateFence(device, &fenceCreateInfo, nullptr, &recordingBatch.fence) != VK_SUCCESS
+        || (dedicatedTransfer && vkCreateSemaphore(device, &semaphoreCreateInfo, nullptr, &recordingBatch.semaphore) != VK_SUCCESS))
+    {
+        destroyBatch(recordingBatch);
+
+        return false;
+    }
+
+    VkCommandBufferBeginInfo commandBufferBeginInfo = {};
+    commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    commandBufferBeginInfo.pNext = nullptr;
+    commandBufferBeginInfo.pInheritanceInfo = nullptr;
+    commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vkBeginCommandBuffer(recordingBatch.commandBuffer, &commandBufferBeginInfo);
+
+    recording = true;
+
+    return true;
+}
+
+void UploadManager::destroyBatch(UploadBatch& batch)
+{
+    for (StagingBuffer& staging : batch.stagingBuffers)
+    {
+        vmaDestroyBuffer(allocator, staging.buffer, staging.allocation);
+    }
+
+    batch.stagingBuffers.clear();
+
+    if (batch.commandBuffer != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(device, commandPool, 1, &batch.commandBuffer);
+    }
+
+    if (batch.fence != VK_NULL_HANDLE)
+    {
+        vkDestroyFence(device, batch.fence, nullptr);
+    }
+
+    if (batch.semaphore != VK_NULL_HANDLE)
+    {
+        vkDestroySemaphore(device, batch.semaphore, nullptr);
+    }
+
+    batch.commandBuffer = VK_NULL_HANDLE;
+    batch.fence = VK_NULL_HANDLE;
+    batch.semaphore = VK_NULL_HANDLE;
+}
@@ -13,18 +13,42 @@ VertexInput::VertexInput()
     VkVertexInputAttributeDescription positionAttribute = {};
     positionAttribute.binding = 0;
     positionAttribute.location = 0;
-    positionAttribute.format = VK_FORMAT_R32G32B32_SFLOAT;
+    positionAttribute.format = VK_FORMAT_R8G8_SNORM;
     positionAttribute.offset = offsetof(struct VertexData, position);
 
     attributeDescriptions.push_back(positionAttribute);
 
-    VkVertexInputAttributeDescription colorAttribute = {};
-    colorAttribute.binding = 0;
-    colorAttribute.location = 1;
-    colorAttribute.format = VK_FORMAT_R32G32B32_SFLOAT;
-    colorAttribute.offset = offsetof(struct VertexData, color);
+    //Instance data, next value is taken for every instance instead of every vertex
+    VkVertexInputBindingDescription instanceBinding = {};
+    instanceBinding.binding = 1;
+    instanceBinding.stride = sizeof(InstanceData);
+    instanceBinding.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
 
-    attributeDescriptions.push_back(colorAttribute);
+    bindingDescriptions.push_back(instanceBinding);
+
+    VkVertexInputAttributeDescription instancePositionAttribute = {};
+    instancePositionAttribute.binding = 1;
+    instancePositionAttribute.location = 1;
+    instancePositionAttribute.format = VK_FORMAT_R32G32_SFLOAT;
+    instancePositionAttribute.offset = offsetof(struct InstanceData, position);
+
+    attributeDescriptions.push_back(instancePositionAttribute);
+
+    VkVertexInputAttributeDescription instanceSizeAttribute = {};
+    instanceSizeAttribute.binding = 1;
+    instanceSizeAttribute.location = 2;
+    instanceSizeAttribute.format = VK_FORMAT_R32G32_SFLOAT;
+    instanceSizeAttribute.offset = offsetof(struct InstanceData, size);
+
+    attributeDescriptions.push_back(instanceSizeAttribute);
+
+    VkVertexInputAttributeDescription instanceColorAttribute = {};
+    instanceColorAttribute.binding = 1;
+    instanceColorAttribute.location = 3;
+    instanceColorAttribute.format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    instanceColorAttribute.offset = offsetof(struct InstanceData, color);
+
+    attributeDescriptions.push_back(instanceColorAttribute);
 }
 
 //Return binding and attributes
@@ -52,3 +76,13 @@ size_t VertexInput::getShapeDataSize()
 {
     return vertices.size() * sizeof(VertexData);
 }
+
+size_t VertexInput::getIndexDataSize()
+{
+    return indices.size() * sizeof(uint16_t);
+}
+
+size_t VertexInput::getInstanceDataSize(int instanceCount)
+{
+    return instanceCount * sizeof(InstanceData);
+}
@@ -1,7 +1,7 @@
 #include "VulkanPipeline.hpp"
 
 //Setup pipeline creation info and create it
-bool VulkanPipeline::createPipeline(VkDevice device, VkRenderPass renderPass)
+bool VulkanPipeline::createPipeline(VkDevice device, VkRenderPass renderPass, VkPipelineCache pipelineCache)
 {
     VkPipelineViewportStateCreateInfo viewportState = {};
     viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
@@ -22,6 +22,13 @@ bool VulkanPipeline::createPipeline(VkDevice device, VkRenderPass renderPass)
     colorBlending.attachmentCount = 1;
     colorBlending.pAttachments = &colorBlendAttachment;
 
+    VkPipelineDynamicStateCreateInfo dynamicState = {};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.pNext = nullptr;
+
+    dynamicState.dynamicStateCount = dynamicStates.size();
+    dynamicState.pDynamicStates = dynamicStates.data();
+
     VkGraphicsPipelineCreateInfo pipelineInfo = {};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
     pipelineInfo.pNext = nullptr;
@@ -34,12 +41,13 @@ bool VulkanPipeline::createPipeline(VkDevice device, VkRenderPass renderPass)
     pipelineInfo.pRasterizationState = &rasterizer;
     pipelineInfo.pMultisampleState = &multisampling;
     pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = dynamicStates.empty() ? nullptr : &dynamicState;
     pipelineInfo.layout = pipelineLayout;
     pipelineInfo.renderPass = renderPass;
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+    if (vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
     {
         return false;
     }
@@ -152,3 +160,8 @@ void VulkanPipeline::setColorBlendAttachment()
 
     colorBlendAttachment.blendEnable = VK_FALSE;
 }
+
+void VulkanPipeline::addDynamicState(VkDynamicState dynamicState)
+{
+    dynamicStates.push_back(dynamicState);
+}
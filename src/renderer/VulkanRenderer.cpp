@@ -1,64 +1,167 @@
 #include "VulkanRenderer.hpp"
 
 #include "external/VkBootstrap.h"
+#include "Profiler.hpp"
+#include "EmbeddedShaders.hpp"
 
 #define VMA_IMPLEMENTATION
 #include "external/vk_mem_alloc.h"
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 
-bool VulkanRenderer::initRenderer(SDL_Window* window, int width, int height, bool debug)
+bool VulkanRenderer::initRenderer(SDL_Window* window, int width, int height, bool debug, const RendererOptions& options)
 {
+    auto initStartTime = std::chrono::steady_clock::now();
+
     //If some step will fail then this variable will become false
     initSuccessful = true;
 
     frameNumber = 0;
 
-    windowExtent.width = width;
-    windowExtent.height = height;
+    this->options = options;
+    stats = RendererStats();
+
+    frames = std::vector<FrameData>(std::max(1, options.framesInFlight));
+
+    this->window = window;
+    offscreen = window == nullptr;
+
+    viewExtent.width = width;
+    viewExtent.height = height;
+
+    windowExtent = viewExtent;
+
+    swapchainOutdated = false;
+    vulkanSwapchain = VK_NULL_HANDLE;
+    lastImageIndex = -1;
+    commandsVersion = 0;
+    capturing = !options.captureFileName.empty();
 
     initVulkan(window, debug);
-    createSwapchain();
+
+    if (!(offscreen ? createOffscreenImages() : createSwapchain()))
+    {
+        initSuccessful = false;
+    }
+
     createCommands();
     initDefaultRenderPass();
-    initFramebuffers();
+
+    if (!initFramebuffers())
+    {
+        initSuccessful = false;
+    }
     initSyncStructures();
+    createTimestampQueryPool();
+
+    if (!createCaptureBuffers())
+    {
+        initSuccessful = false;
+    }
+
+    if (!uploadManager.init(vulkanDevice, vmaAllocator, graphicsQueueFamily, transferQueue, transferQueueFamily))
+    {
+        initSuccessful = false;
+    }
 
     createReactangleShape();
+
+    //Static data is copied while the rest is initialized, first frame waits for it on GPU
+    if (!uploadManager.submit())
+    {
+        initSuccessful = false;
+    }
+    
+    for (FrameData& frame : frames)
+    {
+        if (!frame.uploadArena.create(vmaAllocator, 65536, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT))
+        {
+            initSuccessful = false;
+        }
+
+        frame.instanceCount = 0;
+        frame.allDirty = true;
+    }
+
     initPipeline();
 
+    stats.initSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - initStartTime).count();
+
     return initSuccessful;
 }
 
 //Cleanup everything
 void VulkanRenderer::destroyRenderer()
 {
+    shaderReloader.stop(); //Watcher thread can still build pipeline
+
     vkDeviceWaitIdle(vulkanDevice); //Make sure everything finished before cleaning
 
+    //Frames still in flight are finished now, they are given to writer from the oldest one
+    for (int i = 0; i < (int)frames.size(); i++)
+    {
+        finishCapture(frames[(frameNumber + i) % frames.size()]);
+    }
+
+    frameWriter.close(); //Write queued frames
+
+    if (frameWriter.hasFailed())
+    {
+        std::cerr << "Writing captured frames to " << options.captureFileName << " failed!" << std::endl;
+    }
+
+    for (int i = 0; i < (int)captureBuffers.size(); i++)
+    {
+        vmaDestroyBuffer(vmaAllocator, captureBuffers[i], captureAllocations[i]); //Capture buffers
+    }
+
     vmaDestroyBuffer(vmaAllocator, buffer, allocation); //Destroy vertex buffer data
+    vmaDestroyBuffer(vmaAllocator, indexBuffer, indexAllocation);
+
+    uploadManager.destroy(); //Staging buffers and upload commands
 
     vkDestroyPipelineLayout(vulkanDevice, pipelineLayout, nullptr); //Destroy pipeline layout
 
+    for (ReloadedPipeline& retiredPipeline : retiredPipelines)
+    {
+        ShaderReloader::destroyPipeline(vulkanDevice, retiredPipeline); //Pipelines replaced by reload
+    }
+
     pipeline.destroyPipeline(vulkanDevice); //Destroy pipeline
 
+    pipelineCache.save(); //Pipeline cache
+    pipelineCache.destroy();
+
     vkDestroyShaderModule(vulkanDevice, vertexShader, nullptr); //Fragment shader
     vkDestroyShaderModule(vulkanDevice, fragmentShader, nullptr);
 
-    vkDestroyFence(vulkanDevice, renderFence, nullptr); //Fence
+    for (FrameData& frame : frames)
+    {
+        frame.uploadArena.destroy(); //Instance data
 
-    vkDestroySemaphore(vulkanDevice, presentSemaphore, nullptr); //Semaphores
-    vkDestroySemaphore(vulkanDevice, renderSemaphore, nullptr);
+        vkDestroyFence(vulkanDevice, frame.renderFence, nullptr); //Fence
 
-    vkDestroyCommandPool(vulkanDevice, commandPool, nullptr); //Command pool (will also destroy command buffers)
+        vkDestroySemaphore(vulkanDevice, frame.presentSemaphore, nullptr); //Semaphores
+        vkDestroySemaphore(vulkanDevice, frame.renderSemaphore, nullptr);
 
-    vkDestroyRenderPass(vulkanDevice, renderPass, nullptr); //Render pass
+        vkDestroyCommandPool(vulkanDevice, frame.commandPool, nullptr); //Command pool (will also destroy command buffers)
+        vkDestroyCommandPool(vulkanDevice, frame.recordedCommandPool, nullptr);
+    }
 
-    for (int i = 0; i < swapchainImageViews.size(); i++) //Framebuffers ans swapchain image views
+    if (timestampQueryPool != VK_NULL_HANDLE)
     {
-        vkDestroyFramebuffer(vulkanDevice, framebuffers[i], nullptr);
+        vkDestroyQueryPool(vulkanDevice, timestampQueryPool, nullptr); //Timestamp queries
+    }
 
-        vkDestroyImageView(vulkanDevice, swapchainImageViews[i], nullptr);
+    vkDestroyRenderPass(vulkanDevice, renderPass, nullptr); //Render pass
+
+    destroySwapchainResources(); //Framebuffers ans swapchain image views
+
+    for (int i = 0; i < (int)offscreenImageAllocations.size(); i++)
+    {
+        vmaDestroyImage(vmaAllocator, swapchainImages[i], offscreenImageAllocations[i]); //Offscreen images
     }
 
     vkDestroySwapchainKHR(vulkanDevice, vulkanSwapchain, nullptr); //Swapchain
@@ -78,25 +181,380 @@ void VulkanRenderer::destroyRenderer()
 //It should check for errors as well
 void VulkanRenderer::render()
 {
-    //Wait for render to finish
-    vkWaitForFences(vulkanDevice, 1, &renderFence, true, 1000000000);
-    vkResetFences(vulkanDevice, 1, &renderFence);
+    PROFILE_ZONE("VulkanRenderer::render");
+
+    //Nothing is visible when window is minimized, swapchain can't even be created with zero size
+    if (isMinimized())
+    {
+        drawableShapes.clear();
+
+        return;
+    }
+
+    if (swapchainOutdated && !recreateSwapchain())
+    {
+        drawableShapes.clear();
+
+        return;
+    }
+
+    int frameIndex = frameNumber % frames.size();
+    FrameData& frame = frames[frameIndex];
+
+    auto frameStartTime = std::chrono::steady_clock::now();
+
+    if (stats.frames > 0)
+    {
+        stats.frameSeconds += std::chrono::duration<double>(frameStartTime - lastFrameTime).count();
+    }
+
+    lastFrameTime = frameStartTime;
+
+    //Wait until GPU finished frame which used this slot before, other frames can still be rendered
+    {
+        PROFILE_ZONE("Wait for frame");
+
+        vkWaitForFences(vulkanDevice, 1, &frame.renderFence, true, 1000000000);
+    }
+
+    auto fenceTime = std::chrono::steady_clock::now();
+    stats.fenceWaitSeconds += std::chrono::duration<double>(fenceTime - frameStartTime).count();
+
+    //Frame which used this slot is finished so its timestamps can be read without waiting
+    if (frame.submitted)
+    {
+        stats.latencySeconds += std::chrono::duration<double>(fenceTime - frame.submitTime).count();
+        stats.latencySamples++;
+
+        readTimestamps(frameIndex, frame.frameNumber);
+
+        frame.submitted = false;
+    }
+
+    finishCapture(frame);
+
+    //Frame which used this slot before and all older frames are finished
+    uploadManager.collectFinished((long long)frameNumber - (long long)frames.size());
+    swapReloadedPipeline((long long)frameNumber - (long long)frames.size());
 
-    //Get image from swap chain
     uint32_t swapchainImageIndex;
-    vkAcquireNextImageKHR(vulkanDevice, vulkanSwapchain, 1000000000, presentSemaphore, nullptr, &swapchainImageIndex);
 
-    //Reste command buffer
-    vkResetCommandBuffer(mainCommandBuffer, 0);
+    if (offscreen)
+    {
+        //Offscreen image of this slot is free because fence of this slot was waited
+        swapchainImageIndex = frameIndex;
+    }
+    else
+    {
+        //Get image from swap chain
+        //Fence of this frame is reset only after image was acquired, so skipped frame doesn't leave it unsignaled
+        VkResult acquireResult;
+
+        {
+            PROFILE_ZONE("Acquire image");
+
+            acquireResult = vkAcquireNextImageKHR(vulkanDevice, vulkanSwapchain, 1000000000, frame.presentSemaphore, nullptr, &swapchainImageIndex);
+        }
+
+        if (acquireResult == VK_ERROR_OUT_OF_DATE_KHR)
+        {
+            swapchainOutdated = true;
+            drawableShapes.clear();
+
+            return;
+        }
+
+        //Suboptimal swapchain can still be used, it will be recreated after this frame
+        if (acquireResult == VK_SUBOPTIMAL_KHR)
+        {
+            swapchainOutdated = true;
+        }
+        else if (acquireResult != VK_SUCCESS)
+        {
+            drawableShapes.clear();
+
+            return;
+        }
+
+        //With more frames in flight than swapchain images, image can still be used by older frame
+        if (imagesInFlight[swapchainImageIndex] != VK_NULL_HANDLE)
+        {
+            vkWaitForFences(vulkanDevice, 1, &imagesInFlight[swapchainImageIndex], true, 1000000000);
+        }
+
+        imagesInFlight[swapchainImageIndex] = frame.renderFence;
+    }
+
+    vkResetFences(vulkanDevice, 1, &frame.renderFence);
+
+    //Frame is captured only when it has size of capture file, after resize capture continues when window has the same size again
+    frame.captureBuffer = -1;
+
+    if (capturing && (int)windowExtent.width == frameWriter.getWidth() && (int)windowExtent.height == frameWriter.getHeight())
+    {
+        PROFILE_ZONE("Wait for capture buffer");
+
+        auto captureWaitStart = std::chrono::steady_clock::now();
+
+        frameWriter.waitForBuffer(nextCaptureBuffer);
+
+        stats.captureWaitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - captureWaitStart).count();
+
+        frame.captureBuffer = nextCaptureBuffer;
+        nextCaptureBuffer = (nextCaptureBuffer + 1) % captureBuffers.size();
+    }
+
+    auto cpuStartTime = std::chrono::steady_clock::now();
+
+    frame.waitSemaphores.clear();
+    frame.waitStages.clear();
+
+    if (!offscreen)
+    {
+        frame.waitSemaphores.push_back(frame.presentSemaphore);
+        frame.waitStages.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+    }
+
+    uploadInstances(frame);
+
+    VkCommandBuffer commandBuffer = getCommands(frame, frameIndex, swapchainImageIndex);
+
+    //Submit info
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = nullptr;
+
+    //Frame waits for acquired image and for uploads which it uses first (added when commands were recorded)
+    submitInfo.waitSemaphoreCount = frame.waitSemaphores.size();
+    submitInfo.pWaitSemaphores = frame.waitSemaphores.data();
+    submitInfo.pWaitDstStageMask = frame.waitStages.data();
+
+    //Offscreen image isn't presented so there is nothing to signal
+    submitInfo.signalSemaphoreCount = offscreen ? 0 : 1;
+    submitInfo.pSignalSemaphores = &frame.renderSemaphore;
+
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    //Add to queue
+    {
+        PROFILE_ZONE("Submit");
+
+        vkQueueSubmit(graphicsQueue, 1, &submitInfo, frame.renderFence);
+    }
+
+    frame.submitted = true;
+    frame.submitTime = std::chrono::steady_clock::now();
+    frame.frameNumber = frameNumber;
+
+    lastImageIndex = swapchainImageIndex;
+
+    stats.cpuSeconds += std::chrono::duration<double>(frame.submitTime - cpuStartTime).count();
+    stats.frames++;
+
+    if (offscreen)
+    {
+        drawableShapes.clear();
+        frameNumber++;
+
+        return;
+    }
+
+    //Setup presentation and present things
+    VkPresentInfoKHR presentInfo = {};
+    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    presentInfo.pNext = nullptr;
+    presentInfo.swapchainCount = 1;
+    presentInfo.pSwapchains = &vulkanSwapchain;
+    presentInfo.waitSemaphoreCount = 1;
+    presentInfo.pWaitSemaphores = &frame.renderSemaphore;
+    presentInfo.pImageIndices = &swapchainImageIndex;
+
+    VkResult presentResult;
+
+    {
+        PROFILE_ZONE("Present");
+
+        presentResult = vkQueuePresentKHR(graphicsQueue, &presentInfo);
+    }
+
+    if (presentResult == VK_ERROR_OUT_OF_DATE_KHR || presentResult == VK_SUBOPTIMAL_KHR)
+    {
+        swapchainOutdated = true;
+    }
+
+    //Clear list of objects to render because every object were rendered
+    drawableShapes.clear();
+
+    //Go to next frame
+    frameNumber++;
+}
+
+//Renderer before instancing: every shape has its own model matrix, push constants and draw call
+//Instance buffer stays bound because pipeline has instance attributes, but shader doesn't read them
+void VulkanRenderer::recordShapeDraws(VkCommandBuffer commandBuffer, const glm::mat4& projection, const std::vector<InstanceData>& shapes)
+{
+    glm::mat4 view = glm::mat4(1.0f);
+
+    for (const InstanceData& shape : shapes)
+    {
+        //Quad vertices are in -1..1 range
+        float halfWidth = shape.size.x / 2;
+        float halfHeight = shape.size.y / 2;
+
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(shape.position.x + halfWidth, shape.position.y + halfHeight, 0.0f));
+        model = glm::scale(model, glm::vec3(halfWidth, halfHeight, 1.0f));
+
+        ScenePushConstants pushConstants;
+        pushConstants.projectionMatrix = projection * view * model;
+        pushConstants.shapeColor = shape.color;
+        pushConstants.perShape = 1;
+
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(ScenePushConstants), &pushConstants);
+
+        vkCmdDrawIndexed(commandBuffer, reactangleShape.indices.size(), 1, 0, 0, 0);
+    }
+}
+
+//Write instance data of all shapes to upload arena of this frame
+void VulkanRenderer::uploadInstances(FrameData& frame)
+{
+    PROFILE_ZONE("Upload instances");
+
+    int retainedCount = retainedShapes.size();
+    VkDeviceSize instanceDataSize = reactangleShape.getInstanceDataSize(retainedCount + drawableShapes.size());
+
+    //GPU doesn't use arena of this frame anymore because its fence was waited
+    //Arena is bigger when there are more shapes than before, new buffer doesn't have any retained shape
+    unsigned long long previousGeneration = frame.uploadArena.getGeneration();
+    InstanceData* data = nullptr;
+
+    if (frame.uploadArena.reset(instanceDataSize))
+    {
+        data = (InstanceData*)frame.uploadArena.allocate(instanceDataSize, alignof(InstanceData), frame.instanceOffset);
+    }
+
+    if (data == nullptr)
+    {
+        frame.instanceOffset = 0;
+        frame.instanceCount = 0;
+        frame.allDirty = true;
+        drawableShapes.clear();
+
+        return;
+    }
+
+    if (frame.uploadArena.getGeneration() != previousGeneration)
+    {
+        frame.allDirty = true;
+    }
+
+    //Retained shapes are always at the start of arena, between board changes nothing is copied
+    //Only changed slots are written, so shapes which change every tick don't make their neighbours be written too
+    if (frame.allDirty)
+    {
+        memcpy(data, retainedShapes.data(), retainedCount * sizeof(InstanceData));
+
+        stats.uploadedShapes += retainedCount;
+    }
+    else
+    {
+        for (int slot : frame.dirtySlots)
+        {
+            //Slots after the last one were removed
+            if (slot < retainedCount)
+            {
+                data[slot] = retainedShapes[slot];
+
+                stats.uploadedShapes++;
+            }
+        }
+    }
+
+    for (int slot : frame.dirtySlots)
+    {
+        frame.slotDirty[slot] = 0;
+    }
+
+    frame.dirtySlots.clear();
+    frame.allDirty = false;
+
+    memcpy(data + retainedCount, drawableShapes.data(), drawableShapes.size() * sizeof(InstanceData));
+
+    stats.uploadedShapes += drawableShapes.size();
+
+    frame.instanceCount = retainedCount + drawableShapes.size();
+
+    frame.uploadArena.flush();
+}
+
+//Commands read instance data from arena when GPU executes them, so changed shapes don't need new commands
+//Frame which captures or acquires uploads records its own commands because they are different in every such frame
+VkCommandBuffer VulkanRenderer::getCommands(FrameData& frame, int frameIndex, uint32_t imageIndex)
+{
+    //Draw calls are counted here because reused commands aren't recorded again
+    stats.drawCalls += options.drawPerShape ? frame.instanceCount : (frame.instanceCount > 0 ? 1 : 0);
+
+    bool reusable = options.reuseCommands && !options.drawPerShape && frame.captureBuffer < 0 && !uploadManager.hasUploadsToAcquire() && imageIndex < frame.recordedCommands.size();
+
+    if (!reusable)
+    {
+        //Reset command pool of this frame, it's cheaper than resetting single command buffer
+        vkResetCommandPool(vulkanDevice, frame.commandPool, 0);
+
+        recordCommands(frame, frame.commandBuffer, false, frameIndex, imageIndex);
+
+        stats.recordedFrames++;
+
+        return frame.commandBuffer;
+    }
+
+    RecordedCommands& recorded = frame.recordedCommands[imageIndex];
+
+    if (!recorded.valid || recorded.instanceBufferGeneration != frame.uploadArena.getGeneration() || recorded.instanceOffset != frame.instanceOffset
+        || recorded.instanceCount != frame.instanceCount || recorded.commandsVersion != commandsVersion)
+    {
+        //Pool was created with reset bit, so beginning command buffer resets it
+        recordCommands(frame, recorded.commandBuffer, true, frameIndex, imageIndex);
+
+        recorded.valid = true;
+        recorded.instanceBufferGeneration = frame.uploadArena.getGeneration();
+        recorded.instanceOffset = frame.instanceOffset;
+        recorded.instanceCount = frame.instanceCount;
+        recorded.commandsVersion = commandsVersion;
+
+        stats.recordedFrames++;
+    }
+
+    return recorded.commandBuffer;
+}
+
+//Record all commands of frame to command buffer, reused command buffer can be submitted more times
+void VulkanRenderer::recordCommands(FrameData& frame, VkCommandBuffer commandBuffer, bool reused, int frameIndex, uint32_t imageIndex)
+{
+    PROFILE_ZONE("Record commands");
 
     //Setup command buffer
     VkCommandBufferBeginInfo commandBufferBeginInfo = {};
     commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     commandBufferBeginInfo.pNext = nullptr;
     commandBufferBeginInfo.pInheritanceInfo = nullptr;
-    commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    commandBufferBeginInfo.flags = reused ? 0 : VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
+
+    //Take ownership of buffers uploaded by transfer queue since last frame, reused commands are recorded only when there is nothing to acquire
+    if (!reused)
+    {
+        uploadManager.acquireUploads(commandBuffer, frameNumber, frame.waitSemaphores, frame.waitStages);
+    }
+
+    if (timestampsSupported)
+    {
+        vkCmdResetQueryPool(commandBuffer, timestampQueryPool, frameIndex * TIMESTAMP_COUNT, TIMESTAMP_COUNT);
+    }
 
-    vkBeginCommandBuffer(mainCommandBuffer, &commandBufferBeginInfo);
+    writeTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frameIndex, TIMESTAMP_FRAME_BEGIN);
 
     //Clear screen
     VkClearValue clearValue;
@@ -110,96 +568,358 @@ void VulkanRenderer::render()
     renderPassBeginInfo.renderArea.offset.x = 0;
     renderPassBeginInfo.renderArea.offset.y = 0;
     renderPassBeginInfo.renderArea.extent = windowExtent;
-    renderPassBeginInfo.framebuffer = framebuffers[swapchainImageIndex];
+    renderPassBeginInfo.framebuffer = framebuffers[imageIndex];
     
     renderPassBeginInfo.clearValueCount = 1;
     renderPassBeginInfo.pClearValues = &clearValue;
 
     //Start rendering things
-    vkCmdBeginRenderPass(mainCommandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    writeTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frameIndex, TIMESTAMP_RENDER_PASS_BEGIN);
+
+    vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
     //Bind pipeline
-    vkCmdBindPipeline(mainCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.getPipeline()); 
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.getPipeline()); 
 
-    //Bind vertex buffers
-    VkDeviceSize offset = 0;
-    vkCmdBindVertexBuffers(mainCommandBuffer, 0, 1, &buffer, &offset);
-    
-    //Setup MVP matrix
-    glm::mat4 view = glm::mat4(1.0f);
+    //Viewport is dynamic state so pipeline doesn't have to be rebuilt when window size changes
+    VkViewport viewport;
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = (float)windowExtent.width;
+    viewport.height = (float)windowExtent.height;
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
 
-    glm::mat4 projection = glm::ortho(0.0f, (float)windowExtent.width, 0.0f, (float)windowExtent.height, 0.1f, 100.0f);
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
 
-    //Draw all shapes
-    for (ReactangleShape shape : drawableShapes)
+    VkRect2D scissor;
+    scissor.offset = { 0, 0 };
+    scissor.extent = windowExtent;
+
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    //Nothing is drawn when there are no shapes or arena of frame couldn't be created, render pass still clears image
+    if (frame.instanceCount > 0 && frame.uploadArena.getBuffer() != VK_NULL_HANDLE)
     {
-        //Setup model matrix for every shape
-        //Origin of every shape is selected to be in top left corner so translating should move shape to desired position
-        //and add half of width and height to that position
-        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(shape.x + (shape.width / 2), shape.y + (shape.height / 2), -1.0f));
-        model = glm::scale(model, glm::vec3(shape.width / 2, shape.height / 2, 0.0f));
+        //Bind vertex buffer, instance buffer and index buffer
+        VkBuffer vertexBuffers[2] = { buffer, frame.uploadArena.getBuffer() };
+        VkDeviceSize offsets[2] = { 0, frame.instanceOffset };
+        vkCmdBindVertexBuffers(commandBuffer, 0, 2, vertexBuffers, offsets);
+
+        vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT16);
 
-        //Setup push constants
-        ObjectPushConstants pushConstants;
-        pushConstants.colorVector = glm::vec4(shape.r, shape.g, shape.b, 1.0f);
-        pushConstants.mvpMatrix = projection * view * model;
+        //Scene keeps size given at init and it's stretched to current window size
+        glm::mat4 projection = glm::ortho(0.0f, (float)viewExtent.width, 0.0f, (float)viewExtent.height, 0.1f, 100.0f);
 
-        //Send push constants data to GPU
-        vkCmdPushConstants(mainCommandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(ObjectPushConstants), &pushConstants);
+        if (!options.drawPerShape)
+        {
+            //Projection is the only thing which is the same for all shapes, everything else is in instance data
+            ScenePushConstants pushConstants = {};
+            pushConstants.projectionMatrix = projection;
+
+            vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(ScenePushConstants), &pushConstants);
 
-        //Draw things
-        vkCmdDraw(mainCommandBuffer, reactangleShape.vertices.size(), 1, 0, 0);
+            //Draw all shapes
+            vkCmdDrawIndexed(commandBuffer, reactangleShape.indices.size(), frame.instanceCount, 0, 0, 0);
+        }
+        else
+        {
+            recordShapeDraws(commandBuffer, projection, retainedShapes);
+            recordShapeDraws(commandBuffer, projection, drawableShapes);
+        }
     }
 
     //End of rendering
-    vkCmdEndRenderPass(mainCommandBuffer);
+    vkCmdEndRenderPass(commandBuffer);
 
-    vkEndCommandBuffer(mainCommandBuffer);
+    writeTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frameIndex, TIMESTAMP_RENDER_PASS_END);
+
+    //Render pass left image in transfer source layout when capturing, rows are tightly packed in capture buffer
+    if (frame.captureBuffer >= 0)
+    {
+        VkBufferImageCopy copyRegion = {};
+        copyRegion.bufferOffset = 0;
+        copyRegion.bufferRowLength = 0;
+        copyRegion.bufferImageHeight = 0;
+        copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        copyRegion.imageSubresource.mipLevel = 0;
+        copyRegion.imageSubresource.baseArrayLayer = 0;
+        copyRegion.imageSubresource.layerCount = 1;
+        copyRegion.imageOffset = { 0, 0, 0 };
+        copyRegion.imageExtent = { windowExtent.width, windowExtent.height, 1 };
+
+        vkCmdCopyImageToBuffer(commandBuffer, swapchainImages[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, captureBuffers[frame.captureBuffer], 1, &copyRegion);
+    }
+
+    //Swapchain image has to be in present layout again, present waits for semaphore so copy doesn't need to be made visible
+    if (capturing && !offscreen)
+    {
+        VkImageMemoryBarrier presentBarrier = {};
+        presentBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        presentBarrier.pNext = nullptr;
+        presentBarrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        presentBarrier.dstAccessMask = 0;
+        presentBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        presentBarrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        presentBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        presentBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        presentBarrier.image = swapchainImages[imageIndex];
+        presentBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        presentBarrier.subresourceRange.baseMipLevel = 0;
+        presentBarrier.subresourceRange.levelCount = 1;
+        presentBarrier.subresourceRange.baseArrayLayer = 0;
+        presentBarrier.subresourceRange.layerCount = 1;
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &presentBarrier);
+    }
+
+    writeTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frameIndex, TIMESTAMP_FRAME_END);
+
+    vkEndCommandBuffer(commandBuffer);
+}
+
+//Add object to list of objects to render
+static InstanceData getInstanceData(const ReactangleShape& reactangleShape)
+{
+    InstanceData instance;
+    instance.position = glm::vec2(reactangleShape.x, reactangleShape.y);
+    instance.size = glm::vec2(reactangleShape.width, reactangleShape.height);
+    instance.color = glm::vec4(reactangleShape.r, reactangleShape.g, reactangleShape.b, 1.0f);
+
+    return instance;
+}
+
+void VulkanRenderer::draw(const ReactangleShape& reactangleShape)
+{ 
+    drawableShapes.push_back(getInstanceData(reactangleShape));
+}
+
+ShapeHandle VulkanRenderer::addShape(const ReactangleShape& reactangleShape)
+{
+    ShapeHandle shape;
+
+    if (!freeHandles.empty())
+    {
+        shape = freeHandles.back();
+        freeHandles.pop_back();
+    }
+    else
+    {
+        shape = shapeSlots.size();
+        shapeSlots.push_back(-1);
+    }
+
+    shapeSlots[shape] = retainedShapes.size();
+    slotHandles.push_back(shape);
+    retainedShapes.push_back(getInstanceData(reactangleShape));
+
+    markShapeDirty(shapeSlots[shape]);
+
+    return shape;
+}
+
+void VulkanRenderer::updateShape(ShapeHandle shape, const ReactangleShape& reactangleShape)
+{
+    if (shape < 0 || shape >= (int)shapeSlots.size() || shapeSlots[shape] < 0)
+    {
+        return;
+    }
+
+    int slot = shapeSlots[shape];
+    InstanceData instance = getInstanceData(reactangleShape);
+
+    if (memcmp(&instance, &retainedShapes[slot], sizeof(InstanceData)) == 0)
+    {
+        return;
+    }
+
+    retainedShapes[slot] = instance;
+
+    markShapeDirty(slot);
+}
+
+void VulkanRenderer::removeShape(ShapeHandle shape)
+{
+    if (shape < 0 || shape >= (int)shapeSlots.size() || shapeSlots[shape] < 0)
+    {
+        return;
+    }
+
+    int slot = shapeSlots[shape];
+    int lastSlot = retainedShapes.size() - 1;
+
+    //The last shape fills the hole, so only one shape has to be written again
+    if (slot != lastSlot)
+    {
+        retainedShapes[slot] = retainedShapes[lastSlot];
+        slotHandles[slot] = slotHandles[lastSlot];
+        shapeSlots[slotHandles[slot]] = slot;
+
+        markShapeDirty(slot);
+    }
+
+    retainedShapes.pop_back();
+    slotHandles.pop_back();
+
+    shapeSlots[shape] = -1;
+    freeHandles.push_back(shape);
+}
+
+void VulkanRenderer::markShapeDirty(int slot)
+{
+    for (FrameData& frame : frames)
+    {
+        //Whole arena is written anyway
+        if (frame.allDirty)
+        {
+            continue;
+        }
+
+        if (slot >= (int)frame.slotDirty.size())
+        {
+            frame.slotDirty.resize(slot + 1, 0);
+        }
+
+        if (frame.slotDirty[slot] == 0)
+        {
+            frame.slotDirty[slot] = 1;
+            frame.dirtySlots.push_back(slot);
+        }
+    }
+}
+
+//Called when window size changed, swapchain is recreated before next frame
+void VulkanRenderer::resize()
+{
+    swapchainOutdated = true;
+}
+
+const RendererStats& VulkanRenderer::getStats() const
+{
+    return stats;
+}
+
+const GpuTimings& VulkanRenderer::getGpuTimings() const
+{
+    return gpuTimings;
+}
+
+bool VulkanRenderer::isOffscreen() const
+{
+    return offscreen;
+}
+
+//Copy last rendered offscreen image to host visible buffer and convert it to RGB
+//It waits until GPU finished everything, so it's meant for tests and screenshots, not for every frame
+bool VulkanRenderer::readImage(std::vector<unsigned char>& pixels)
+{
+    if (!offscreen || lastImageIndex < 0)
+    {
+        return false;
+    }
+
+    vkDeviceWaitIdle(vulkanDevice);
+
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = (VkDeviceSize)windowExtent.width * windowExtent.height * 4;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    VmaAllocationCreateInfo vmaAllocationInfo = {};
+    vmaAllocationInfo.usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
+
+    VkBuffer readbackBuffer;
+    VmaAllocation readbackAllocation;
+
+    if (vmaCreateBuffer(vmaAllocator, &bufferInfo, &vmaAllocationInfo, &readbackBuffer, &readbackAllocation, nullptr) != VK_SUCCESS)
+    {
+        return false;
+    }
+
+    //Every frame is finished so command pool of any frame can be used
+    FrameData& frame = frames[0];
+
+    vkResetCommandPool(vulkanDevice, frame.commandPool, 0);
+
+    VkCommandBufferBeginInfo commandBufferBeginInfo = {};
+    commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    commandBufferBeginInfo.pNext = nullptr;
+    commandBufferBeginInfo.pInheritanceInfo = nullptr;
+    commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vkBeginCommandBuffer(frame.commandBuffer, &commandBufferBeginInfo);
+
+    //Render pass left image in transfer source layout, rows are tightly packed in buffer
+    VkBufferImageCopy copyRegion = {};
+    copyRegion.bufferOffset = 0;
+    copyRegion.bufferRowLength = 0;
+    copyRegion.bufferImageHeight = 0;
+    copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    copyRegion.imageSubresource.mipLevel = 0;
+    copyRegion.imageSubresource.baseArrayLayer = 0;
+    copyRegion.imageSubresource.layerCount = 1;
+    copyRegion.imageOffset = { 0, 0, 0 };
+    copyRegion.imageExtent = { windowExtent.width, windowExtent.height, 1 };
+
+    vkCmdCopyImageToBuffer(frame.commandBuffer, swapchainImages[lastImageIndex], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffer, 1, &copyRegion);
+
+    vkEndCommandBuffer(frame.commandBuffer);
 
-    //Submit info
     VkSubmitInfo submitInfo = {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     submitInfo.pNext = nullptr;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &frame.commandBuffer;
 
-    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    bool copied = vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) == VK_SUCCESS && vkQueueWaitIdle(graphicsQueue) == VK_SUCCESS;
 
-    submitInfo.pWaitDstStageMask = &waitStage;
+    if (copied)
+    {
+        void* data;
+        vmaMapMemory(vmaAllocator, readbackAllocation, &data);
+        vmaInvalidateAllocation(vmaAllocator, readbackAllocation, 0, VK_WHOLE_SIZE);
 
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = &presentSemaphore;
+        //Image is BGRA
+        const unsigned char* imagePixels = (const unsigned char*)data;
+        int pixelCount = windowExtent.width * windowExtent.height;
 
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = &renderSemaphore;
+        pixels.resize(pixelCount * 3);
 
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &mainCommandBuffer;
+        for (int i = 0; i < pixelCount; i++)
+        {
+            pixels[i * 3] = imagePixels[i * 4 + 2];
+            pixels[i * 3 + 1] = imagePixels[i * 4 + 1];
+            pixels[i * 3 + 2] = imagePixels[i * 4];
+        }
 
-    //Add to queue
-    vkQueueSubmit(graphicsQueue, 1, &submitInfo, renderFence);
+        vmaUnmapMemory(vmaAllocator, readbackAllocation);
+    }
 
-    //Setup presentation and present things
-    VkPresentInfoKHR presentInfo = {};
-    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-    presentInfo.pNext = nullptr;
-    presentInfo.swapchainCount = 1;
-    presentInfo.pSwapchains = &vulkanSwapchain;
-    presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = &renderSemaphore;
-    presentInfo.pImageIndices = &swapchainImageIndex;
+    vmaDestroyBuffer(vmaAllocator, readbackBuffer, readbackAllocation);
 
-    vkQueuePresentKHR(graphicsQueue, &presentInfo);
+    return copied;
+}
 
-    //Clear list of objects to render because every object were rendered
-    drawableShapes.clear();
+bool VulkanRenderer::saveImage(const std::string& fileName)
+{
+    std::vector<unsigned char> pixels;
 
-    //Go to next frame
-    frameNumber++;
-}
+    if (!readImage(pixels))
+    {
+        return false;
+    }
 
-//Add object to list of objects to render
-void VulkanRenderer::draw(ReactangleShape reactangleShape)
-{ 
-    drawableShapes.push_back(reactangleShape);
+    std::ofstream imageFile(fileName, std::ios::binary);
+
+    if (!imageFile.is_open())
+    {
+        return false;
+    }
+
+    imageFile << "P6\n" << windowExtent.width << " " << windowExtent.height << "\n255\n";
+    imageFile.write((const char*)pixels.data(), pixels.size());
+
+    return imageFile.good();
 }
 
 void VulkanRenderer::initVulkan(SDL_Window* window, bool debug)
@@ -209,30 +929,40 @@ void VulkanRenderer::initVulkan(SDL_Window* window, bool debug)
     //Should probablably check for errors as well
 
     //Init instance
-    auto builderInstance = instanceBuilder.set_app_name("vkSnake")
+    //Headless instance doesn't need surface extensions, so it works without window system
+    instanceBuilder.set_app_name("vkSnake")
             .request_validation_layers(debug)
             .require_api_version(1, 0, 0)
             .use_default_debug_messenger()
-            .build();
+            .set_headless(window == nullptr);
+
+    auto builderInstance = instanceBuilder.build();
 
     vkb::Instance vkbInstance = builderInstance.value();
 
     vulkanInstance = vkbInstance.instance;
     debugMessenger = vkbInstance.debug_messenger;
 
-    //Create SDL surface
-    if (SDL_Vulkan_CreateSurface(window, vulkanInstance, &vulkanSurface) == SDL_FALSE)
+    //Pick physical device and setup logical device
+    vkb::PhysicalDeviceSelector selector { vkbInstance };
+    selector.set_minimum_version(1, 0);
+
+    vulkanSurface = VK_NULL_HANDLE;
+
+    //Without window there is no surface and device doesn't have to support presentation
+    if (window != nullptr)
     {
-        initSuccessful = false;
-        return;
+        //Create SDL surface
+        if (SDL_Vulkan_CreateSurface(window, vulkanInstance, &vulkanSurface) == SDL_FALSE)
+        {
+            initSuccessful = false;
+            return;
+        }
+
+        selector.set_surface(vulkanSurface);
     }
 
-    //Pick physical device and setup logical device
-    vkb::PhysicalDeviceSelector selector { vkbInstance };
-    vkb::PhysicalDevice vkbPhysicalDevice = selector.set_minimum_version(1, 0)
-                            .set_surface(vulkanSurface)
-                            .select()
-                            .value();
+    vkb::PhysicalDevice vkbPhysicalDevice = selector.select().value();
 
     vkb::DeviceBuilder deviceBuilder { vkbPhysicalDevice };
 
@@ -245,34 +975,210 @@ void VulkanRenderer::initVulkan(SDL_Window* window, bool debug)
     graphicsQueue = vkbDevice.get_queue(vkb::QueueType::graphics).value();
     graphicsQueueFamily = vkbDevice.get_queue_index(vkb::QueueType::graphics).value();
 
+    //Queue family only for transfers can copy while graphics queue renders, graphics queue is used when there isn't one
+    auto dedicatedTransferQueue = vkbDevice.get_dedicated_queue(vkb::QueueType::transfer);
+
+    if (dedicatedTransferQueue.has_value())
+    {
+        transferQueue = dedicatedTransferQueue.value();
+        transferQueueFamily = vkbDevice.get_dedicated_queue_index(vkb::QueueType::transfer).value();
+    }
+    else
+    {
+        transferQueue = graphicsQueue;
+        transferQueueFamily = graphicsQueueFamily;
+    }
+
     //Setup allocator
     VmaAllocatorCreateInfo allocatorInfo = {};
     allocatorInfo.physicalDevice = physicalDevice;
     allocatorInfo.device = vulkanDevice;
     allocatorInfo.instance = vulkanInstance;
 
-    vmaCreateAllocator(&allocatorInfo, &vmaAllocator);
+    vmaCreateAllocator(&allocatorInfo, &vmaAllocator);
+}
+
+//Setup swapchain
+//Old swapchain is given to builder so presentation engine can reuse its resources
+bool VulkanRenderer::createSwapchain()
+{
+    //Swapchain should have size of window, not size of scene
+    int drawableWidth, drawableHeight;
+    SDL_Vulkan_GetDrawableSize(window, &drawableWidth, &drawableHeight);
+
+    vkb::SwapchainBuilder swapchainBuilder { physicalDevice, vulkanDevice, vulkanSurface };
+
+    swapchainBuilder.use_default_format_selection()
+                    .set_desired_present_mode(options.presentMode)
+                    .set_desired_extent(drawableWidth, drawableHeight)
+                    .set_old_swapchain(vulkanSwapchain);
+
+    //Mailbox and immediate modes don't wait for vertical sync so one can replace the other, FIFO is always the last fallback
+    if (options.presentMode == VK_PRESENT_MODE_MAILBOX_KHR)
+    {
+        swapchainBuilder.add_fallback_present_mode(VK_PRESENT_MODE_IMMEDIATE_KHR);
+    }
+    else if (options.presentMode == VK_PRESENT_MODE_IMMEDIATE_KHR)
+    {
+        swapchainBuilder.add_fallback_present_mode(VK_PRESENT_MODE_MAILBOX_KHR);
+    }
+
+    swapchainBuilder.add_fallback_present_mode(VK_PRESENT_MODE_FIFO_KHR);
+
+    //Captured frames are copied from swapchain images
+    if (capturing)
+    {
+        swapchainBuilder.add_image_usage_flags(VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+    }
+
+    auto builderSwapchain = swapchainBuilder.build();
+
+    if (!builderSwapchain.has_value())
+    {
+        return false;
+    }
+
+    vkb::Swapchain vkbSwapchain = builderSwapchain.value();
+
+    vulkanSwapchain = vkbSwapchain.swapchain;
+    swapchainImages = vkbSwapchain.get_images().value();
+    swapchainImageViews = vkbSwapchain.get_image_views().value();
+
+    swapchainImageFormat = vkbSwapchain.image_format;
+    windowExtent = vkbSwapchain.extent;
+
+    return true;
+}
+
+//Rebuild swapchain, its image views and framebuffers with current window size
+//Render pass and pipeline stay the same because image format doesn't change and viewport is dynamic
+bool VulkanRenderer::recreateSwapchain()
+{
+    //Framebuffers can be still used by frames in flight
+    vkDeviceWaitIdle(vulkanDevice);
+
+    destroySwapchainResources();
+
+    VkSwapchainKHR oldSwapchain = vulkanSwapchain;
+
+    bool created = createSwapchain();
+
+    vkDestroySwapchainKHR(vulkanDevice, oldSwapchain, nullptr);
+
+    if (!created)
+    {
+        //Try again in next frame
+        vulkanSwapchain = VK_NULL_HANDLE;
+        swapchainImageViews.clear();
+
+        return false;
+    }
+
+    //Commands of old images used old framebuffers, number of images can change too
+    bool recreated = initFramebuffers() && allocateRecordedCommands();
+
+    //Old frames are finished, new images weren't used by any frame yet
+    imagesInFlight = std::vector<VkFence>(swapchainImages.size(), VK_NULL_HANDLE);
+
+    //Try again in next frame when something failed
+    swapchainOutdated = !recreated;
+
+    return recreated;
+}
+
+//Offscreen images have format chosen by default swapchain format selection, so saved images match window contents
+//They are copied to host after render pass, so they are also transfer sources
+bool VulkanRenderer::createOffscreenImages()
+{
+    swapchainImageFormat = VK_FORMAT_B8G8R8A8_SRGB;
+
+    VkImageCreateInfo imageInfo = {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.pNext = nullptr;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = swapchainImageFormat;
+    imageInfo.extent = { windowExtent.width, windowExtent.height, 1 };
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VmaAllocationCreateInfo vmaAllocationInfo = {};
+    vmaAllocationInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    VkImageViewCreateInfo imageViewInfo = {};
+    imageViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    imageViewInfo.pNext = nullptr;
+    imageViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    imageViewInfo.format = swapchainImageFormat;
+    imageViewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    imageViewInfo.subresourceRange.baseMipLevel = 0;
+    imageViewInfo.subresourceRange.levelCount = 1;
+    imageViewInfo.subresourceRange.baseArrayLayer = 0;
+    imageViewInfo.subresourceRange.layerCount = 1;
+
+    for (int i = 0; i < (int)frames.size(); i++)
+    {
+        VkImage image;
+        VmaAllocation imageAllocation;
+
+        if (vmaCreateImage(vmaAllocator, &imageInfo, &vmaAllocationInfo, &image, &imageAllocation, nullptr) != VK_SUCCESS)
+        {
+            return false;
+        }
+
+        swapchainImages.push_back(image);
+        offscreenImageAllocations.push_back(imageAllocation);
+
+        imageViewInfo.image = image;
+
+        VkImageView imageView;
+
+        if (vkCreateImageView(vulkanDevice, &imageViewInfo, nullptr, &imageView) != VK_SUCCESS)
+        {
+            return false;
+        }
+
+        swapchainImageViews.push_back(imageView);
+    }
+
+    return true;
 }
 
-//Setup swapchain
-void VulkanRenderer::createSwapchain()
+void VulkanRenderer::destroySwapchainResources()
 {
-    vkb::SwapchainBuilder swapchainBuilder { physicalDevice, vulkanDevice, vulkanSurface };
+    for (int i = 0; i < (int)framebuffers.size(); i++)
+    {
+        vkDestroyFramebuffer(vulkanDevice, framebuffers[i], nullptr);
+    }
 
-    vkb::Swapchain vkbSwapchain = swapchainBuilder.use_default_format_selection()
-                    .set_desired_present_mode(VK_PRESENT_MODE_FIFO_KHR)
-                    .set_desired_extent(windowExtent.width, windowExtent.height)
-                    .build()
-                    .value();
+    for (int i = 0; i < (int)swapchainImageViews.size(); i++)
+    {
+        vkDestroyImageView(vulkanDevice, swapchainImageViews[i], nullptr);
+    }
 
-    vulkanSwapchain = vkbSwapchain.swapchain;
-    swapchainImages = vkbSwapchain.get_images().value();
-    swapchainImageViews = vkbSwapchain.get_image_views().value();
+    framebuffers.clear();
+    swapchainImageViews.clear();
+}
 
-    swapchainImageFormat = vkbSwapchain.image_format;
+bool VulkanRenderer::isMinimized()
+{
+    if (offscreen)
+    {
+        return false;
+    }
+
+    int drawableWidth, drawableHeight;
+    SDL_Vulkan_GetDrawableSize(window, &drawableWidth, &drawableHeight);
+
+    return (SDL_GetWindowFlags(window) & SDL_WINDOW_MINIMIZED) || drawableWidth == 0 || drawableHeight == 0;
 }
 
 //Create commands buffers
+//Every frame has its own pool so it can be reset while other frames are still executed
 void VulkanRenderer::createCommands()
 {
     VkCommandPoolCreateInfo commandPoolInfo = {};
@@ -280,28 +1186,88 @@ void VulkanRenderer::createCommands()
     commandPoolInfo.pNext = nullptr;
 
     commandPoolInfo.queueFamilyIndex = graphicsQueueFamily;
-    commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
 
-    if (vkCreateCommandPool(vulkanDevice, &commandPoolInfo, nullptr, &commandPool) != VK_SUCCESS)
+    for (FrameData& frame : frames)
     {
-        initSuccessful = false;
-        return;
-    }
+        if (vkCreateCommandPool(vulkanDevice, &commandPoolInfo, nullptr, &frame.commandPool) != VK_SUCCESS)
+        {
+            initSuccessful = false;
+            return;
+        }
+
+        VkCommandBufferAllocateInfo commandBufferAllocateInfo = {};
+        commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        commandBufferAllocateInfo.pNext = nullptr;
+        commandBufferAllocateInfo.commandPool = frame.commandPool;
+        commandBufferAllocateInfo.commandBufferCount = 1;
+        commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+
+        if (vkAllocateCommandBuffers(vulkanDevice, &commandBufferAllocateInfo, &frame.commandBuffer))
+        {
+            initSuccessful = false;
+            return;
+        }
+
+        //Reused command buffers are recorded again one by one, so they can't share pool reset
+        VkCommandPoolCreateInfo recordedPoolInfo = commandPoolInfo;
+        recordedPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
-    VkCommandBufferAllocateInfo commandBufferAllocateInfo = {};
-    commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    commandBufferAllocateInfo.pNext = nullptr;
-    commandBufferAllocateInfo.commandPool = commandPool;
-    commandBufferAllocateInfo.commandBufferCount = 1;
-    commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        if (vkCreateCommandPool(vulkanDevice, &recordedPoolInfo, nullptr, &frame.recordedCommandPool) != VK_SUCCESS)
+        {
+            initSuccessful = false;
+            return;
+        }
+    }
 
-    if (vkAllocateCommandBuffers(vulkanDevice, &commandBufferAllocateInfo, &mainCommandBuffer))
+    if (!allocateRecordedCommands())
     {
         initSuccessful = false;
-        return;
     }
 }
 
+//GPU must be idle, all commands recorded before are thrown away
+bool VulkanRenderer::allocateRecordedCommands()
+{
+    for (FrameData& frame : frames)
+    {
+        for (RecordedCommands& recorded : frame.recordedCommands)
+        {
+            vkFreeCommandBuffers(vulkanDevice, frame.recordedCommandPool, 1, &recorded.commandBuffer);
+        }
+
+        frame.recordedCommands.clear();
+
+        if (!options.reuseCommands || options.drawPerShape || swapchainImages.empty())
+        {
+            continue;
+        }
+
+        std::vector<VkCommandBuffer> commandBuffers(swapchainImages.size());
+
+        VkCommandBufferAllocateInfo commandBufferAllocateInfo = {};
+        commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        commandBufferAllocateInfo.pNext = nullptr;
+        commandBufferAllocateInfo.commandPool = frame.recordedCommandPool;
+        commandBufferAllocateInfo.commandBufferCount = commandBuffers.size();
+        commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+
+        if (vkAllocateCommandBuffers(vulkanDevice, &commandBufferAllocateInfo, commandBuffers.data()) != VK_SUCCESS)
+        {
+            return false;
+        }
+
+        frame.recordedCommands = std::vector<RecordedCommands>(commandBuffers.size());
+
+        for (int i = 0; i < (int)commandBuffers.size(); i++)
+        {
+            frame.recordedCommands[i].commandBuffer = commandBuffers[i];
+        }
+    }
+
+    return true;
+}
+
 //Setup render pass
 void VulkanRenderer::initDefaultRenderPass()
 {
@@ -313,7 +1279,7 @@ void VulkanRenderer::initDefaultRenderPass()
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    colorAttachment.finalLayout = offscreen || capturing ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
     VkAttachmentReference colorAttachmentReference = {};
     colorAttachmentReference.attachment = 0;
@@ -331,6 +1297,21 @@ void VulkanRenderer::initDefaultRenderPass()
     renderPassInfo.subpassCount = 1;
     renderPassInfo.pSubpasses = &subpassDescription;
 
+    //Offscreen or captured image can be copied to host after render pass, copy has to wait for color writes
+    VkSubpassDependency readbackDependency = {};
+    readbackDependency.srcSubpass = 0;
+    readbackDependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+    readbackDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    readbackDependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    readbackDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    readbackDependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    if (offscreen || capturing)
+    {
+        renderPassInfo.dependencyCount = 1;
+        renderPassInfo.pDependencies = &readbackDependency;
+    }
+
     if (vkCreateRenderPass(vulkanDevice, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS)
     {
         initSuccessful = false;
@@ -339,7 +1320,7 @@ void VulkanRenderer::initDefaultRenderPass()
 }
 
 //Setup framebuffers
-void VulkanRenderer::initFramebuffers()
+bool VulkanRenderer::initFramebuffers()
 {
     VkFramebufferCreateInfo framebufferInfo = {};
     framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
@@ -359,110 +1340,290 @@ void VulkanRenderer::initFramebuffers()
 
         if (vkCreateFramebuffer(vulkanDevice, &framebufferInfo, nullptr, &framebuffers[i]) != VK_SUCCESS)
         {
-            initSuccessful = false;
-            return;
+            return false;
         }
     }
+
+    return true;
 }
 
 //Setup fences and semaphores
 void VulkanRenderer::initSyncStructures()
 {
+    //Fences start signaled so first wait in every frame doesn't block
     VkFenceCreateInfo fenceCreateInfo = {};
     fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
     fenceCreateInfo.pNext = nullptr;
     fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-    if (vkCreateFence(vulkanDevice, &fenceCreateInfo, nullptr, &renderFence) != VK_SUCCESS)
-    {
-        initSuccessful = false;
-        return;
-    }
-
     VkSemaphoreCreateInfo semaphoreCreateInfo = {};
     semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
     semaphoreCreateInfo.pNext = nullptr;
     semaphoreCreateInfo.flags = 0;
 
-    if (vkCreateSemaphore(vulkanDevice, &semaphoreCreateInfo, nullptr, &presentSemaphore) != VK_SUCCESS)
+    for (FrameData& frame : frames)
+    {
+        frame.submitted = false;
+        frame.captureBuffer = -1;
+
+        if (vkCreateFence(vulkanDevice, &fenceCreateInfo, nullptr, &frame.renderFence) != VK_SUCCESS)
+        {
+            initSuccessful = false;
+            return;
+        }
+
+        if (vkCreateSemaphore(vulkanDevice, &semaphoreCreateInfo, nullptr, &frame.presentSemaphore) != VK_SUCCESS)
+        {
+            initSuccessful = false;
+            return;
+        }
+
+        if (vkCreateSemaphore(vulkanDevice, &semaphoreCreateInfo, nullptr, &frame.renderSemaphore) != VK_SUCCESS)
+        {
+            initSuccessful = false;
+            return;
+        }
+    }
+
+    imagesInFlight = std::vector<VkFence>(swapchainImages.size(), VK_NULL_HANDLE);
+}
+
+//Setup timestamp queries
+//Timestamps are optional, if graphics queue doesn't support them GPU times are just not measured
+void VulkanRenderer::createTimestampQueryPool()
+{
+    timestampQueryPool = VK_NULL_HANDLE;
+    timestampsSupported = false;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+    uint32_t validBits = graphicsQueueFamily < queueFamilyCount ? queueFamilies[graphicsQueueFamily].timestampValidBits : 0;
+
+    if (validBits == 0 || properties.limits.timestampPeriod <= 0.0f)
     {
-        initSuccessful = false;
         return;
     }
 
-    if (vkCreateSemaphore(vulkanDevice, &semaphoreCreateInfo, nullptr, &renderSemaphore) != VK_SUCCESS)
+    timestampPeriod = properties.limits.timestampPeriod;
+    timestampMask = validBits >= 64 ? ~0ULL : (1ULL << validBits) - 1;
+
+    VkQueryPoolCreateInfo queryPoolInfo = {};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.pNext = nullptr;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = frames.size() * TIMESTAMP_COUNT;
+
+    if (vkCreateQueryPool(vulkanDevice, &queryPoolInfo, nullptr, &timestampQueryPool) != VK_SUCCESS)
+    {
+        timestampQueryPool = VK_NULL_HANDLE;
+        return;
+    }
+
+    timestampsSupported = true;
+}
+
+//Fence of frame was already waited, so results are available and reading them doesn't stall
+void VulkanRenderer::readTimestamps(int frameIndex, long long frameNumber)
+{
+    if (!timestampsSupported)
+    {
+        return;
+    }
+
+    uint64_t timestamps[TIMESTAMP_COUNT];
+
+    if (vkGetQueryPoolResults(vulkanDevice, timestampQueryPool, frameIndex * TIMESTAMP_COUNT, TIMESTAMP_COUNT, sizeof(timestamps), timestamps,
+        sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
     {
-        initSuccessful = false;
         return;
     }
+
+    auto milliseconds = [this, &timestamps](Timestamp begin, Timestamp end)
+    {
+        return ((timestamps[end] - timestamps[begin]) & timestampMask) * timestampPeriod / 1000000.0;
+    };
+
+    gpuTimings.valid = true;
+    gpuTimings.frame = frameNumber;
+    gpuTimings.frameMilliseconds = milliseconds(TIMESTAMP_FRAME_BEGIN, TIMESTAMP_FRAME_END);
+    gpuTimings.renderPassMilliseconds = milliseconds(TIMESTAMP_RENDER_PASS_BEGIN, TIMESTAMP_RENDER_PASS_END);
+
+    stats.gpuSeconds += gpuTimings.frameMilliseconds / 1000.0;
+    stats.gpuSamples++;
+
+    if (options.gpuTimingLogInterval > 0 && frameNumber % options.gpuTimingLogInterval == 0)
+    {
+        std::cout << "Frame " << frameNumber << " GPU time: " << gpuTimings.frameMilliseconds << " ms, render pass: "
+            << gpuTimings.renderPassMilliseconds << " ms" << std::endl;
+    }
+}
+
+void VulkanRenderer::writeTimestamp(VkCommandBuffer commandBuffer, VkPipelineStageFlagBits stage, int frameIndex, Timestamp timestamp)
+{
+    if (timestampsSupported)
+    {
+        vkCmdWriteTimestamp(commandBuffer, stage, timestampQueryPool, frameIndex * TIMESTAMP_COUNT + timestamp);
+    }
 }
 
 //Setup vertex input
 void VulkanRenderer::createReactangleShape()
 {
-    reactangleShape.vertices.resize(6);
+    //Corners in clockwise order from top left, two triangles share diagonal
+    reactangleShape.vertices.resize(4);
+
+    reactangleShape.vertices[0] = { { -127, 127 } };
+    reactangleShape.vertices[1] = { { 127, 127 } };
+    reactangleShape.vertices[2] = { { 127, -127 } };
+    reactangleShape.vertices[3] = { { -127, -127 } };
+
+    reactangleShape.indices = { 0, 1, 2, 2, 3, 0 };
+
+    //Vertices and indices never change so they are in device local memory, copy is submitted at the end of initialization
+    if (!uploadManager.uploadBuffer(reactangleShape.vertices.data(), reactangleShape.getShapeDataSize(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, buffer, allocation))
+    {
+        initSuccessful = false;
+        return;
+    }
+
+    if (!uploadManager.uploadBuffer(reactangleShape.indices.data(), reactangleShape.getIndexDataSize(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, indexBuffer, indexAllocation))
+    {
+        initSuccessful = false;
+        return;
+    }
+}
+
+//Capture buffers are persistently mapped so writer thread reads frames directly from them
+//There are at least as many buffers as frames in flight, so buffer used in ring order is never used by unfinished frame
+bool VulkanRenderer::createCaptureBuffers()
+{
+    nextCaptureBuffer = 0;
+
+    if (!capturing)
+    {
+        return true;
+    }
+
+    bool bgra = swapchainImageFormat == VK_FORMAT_B8G8R8A8_SRGB || swapchainImageFormat == VK_FORMAT_B8G8R8A8_UNORM;
+    bool rgba = swapchainImageFormat == VK_FORMAT_R8G8B8A8_SRGB || swapchainImageFormat == VK_FORMAT_R8G8B8A8_UNORM;
+
+    if (!bgra && !rgba)
+    {
+        std::cerr << "Capture doesn't support swapchain format " << swapchainImageFormat << std::endl;
 
-    reactangleShape.vertices[0].position = { -1.0f, 1.0f, 0.0f };
-    reactangleShape.vertices[1].position = { 1.0f, 1.0f, 0.0f };
-    reactangleShape.vertices[2].position = { 1.0f, -1.0f, 0.0f };
+        return false;
+    }
 
-    reactangleShape.vertices[3].position = { 1.0f, -1.0f, 0.0f };
-    reactangleShape.vertices[4].position = { -1.0f, -1.0f, 0.0f };
-    reactangleShape.vertices[5].position = { -1.0f, 1.0f, 0.0f };
+    int bufferCount = std::max(options.captureBufferCount, (int)frames.size());
 
-    reactangleShape.vertices[0].color = { 1.0f, 0.0f, 0.0f };
-    reactangleShape.vertices[1].color = { 1.0f, 0.0f, 0.0f };
-    reactangleShape.vertices[2].color = { 1.0f, 0.0f, 0.0f };
+    if (!frameWriter.open(options.captureFileName, windowExtent.width, windowExtent.height, bufferCount, bgra, options.captureFrameRate))
+    {
+        std::cerr << "Opening capture file " << options.captureFileName << " failed!" << std::endl;
 
-    reactangleShape.vertices[3].color = { 1.0f, 0.0f, 0.0f };
-    reactangleShape.vertices[4].color = { 1.0f, 0.0f, 0.0f };
-    reactangleShape.vertices[5].color = { 1.0f, 0.0f, 0.0f };
+        return false;
+    }
 
     VkBufferCreateInfo bufferInfo = {};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = reactangleShape.getShapeDataSize();
-    bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    bufferInfo.size = (VkDeviceSize)windowExtent.width * windowExtent.height * 4;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
 
     VmaAllocationCreateInfo vmaAllocationInfo = {};
-    vmaAllocationInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    vmaAllocationInfo.usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
+    vmaAllocationInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
 
-    if (vmaCreateBuffer(vmaAllocator, &bufferInfo, &vmaAllocationInfo, &buffer, &allocation, nullptr) != VK_SUCCESS)
+    for (int i = 0; i < bufferCount; i++)
+    {
+        VkBuffer captureBuffer;
+        VmaAllocation captureAllocation;
+        VmaAllocationInfo allocationInfo;
+
+        if (vmaCreateBuffer(vmaAllocator, &bufferInfo, &vmaAllocationInfo, &captureBuffer, &captureAllocation, &allocationInfo) != VK_SUCCESS)
+        {
+            return false;
+        }
+
+        captureBuffers.push_back(captureBuffer);
+        captureAllocations.push_back(captureAllocation);
+        captureData.push_back((const unsigned char*)allocationInfo.pMappedData);
+    }
+
+    return true;
+}
+
+//Called after fence of frame was waited, so GPU finished copy
+void VulkanRenderer::finishCapture(FrameData& frame)
+{
+    if (frame.captureBuffer < 0)
     {
-        initSuccessful = false;
         return;
     }
 
-    void* data;
-    vmaMapMemory(vmaAllocator, allocation, &data);
-    memcpy(data, reactangleShape.vertices.data(), reactangleShape.getShapeDataSize());
-    vmaUnmapMemory(vmaAllocator, allocation);
+    //Memory doesn't have to be coherent
+    vmaInvalidateAllocation(vmaAllocator, captureAllocations[frame.captureBuffer], 0, VK_WHOLE_SIZE);
+
+    frameWriter.write(frame.captureBuffer, captureData[frame.captureBuffer]);
+
+    frame.captureBuffer = -1;
+
+    stats.capturedFrames++;
 }
 
-//Create shader module from selected file
-VkShaderModule VulkanRenderer::createShaderModule(const char* fileName)
+//Create shader module from embedded SPIR-V or from file in shader directory when it's set
+//File is read to uint32_t vector so code is aligned as Vulkan requires
+VkShaderModule VulkanRenderer::createShaderModule(const char* name)
 {
-    std::ifstream spvShaderFile(fileName, std::ios::ate | std::ios::binary);
+    const uint32_t* code = nullptr;
+    size_t codeSize = 0;
+
+    std::vector<uint32_t> fileCode;
 
-    if (!spvShaderFile.is_open())
+    if (!options.shaderDirectory.empty())
     {
-        return NULL;
-    }
+        std::string fileName = options.shaderDirectory + "/" + name + ".spv";
+        std::ifstream spvShaderFile(fileName, std::ios::ate | std::ios::binary);
 
-    size_t fileSize = (size_t)spvShaderFile.tellg();
+        size_t fileSize = spvShaderFile.is_open() ? (size_t)spvShaderFile.tellg() : 0;
 
-    std::vector<char> fileBuffer(fileSize);
+        if (fileSize > 0 && fileSize % 4 == 0)
+        {
+            fileCode.resize(fileSize / 4);
+
+            spvShaderFile.seekg(0);
+            spvShaderFile.read((char*)fileCode.data(), fileSize);
+
+            code = fileCode.data();
+            codeSize = fileSize;
+        }
+        else
+        {
+            std::cerr << "Loading shader " << fileName << " failed, embedded shader is used" << std::endl;
+        }
+    }
 
-    spvShaderFile.seekg(0);
-    spvShaderFile.read(fileBuffer.data(), fileSize);
+    if (code == nullptr && !EmbeddedShaders::getShader(name, code, codeSize))
+    {
+        return NULL;
+    }
 
-    spvShaderFile.close();
+    return createShaderModule(code, codeSize);
+}
 
+VkShaderModule VulkanRenderer::createShaderModule(const uint32_t* code, size_t codeSize)
+{
     VkShaderModuleCreateInfo shaderCreateInfo = {};
     shaderCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
     shaderCreateInfo.pNext = nullptr;
     
-    shaderCreateInfo.codeSize = fileBuffer.size();
-    shaderCreateInfo.pCode = reinterpret_cast<const uint32_t*>(fileBuffer.data());
+    shaderCreateInfo.codeSize = codeSize;
+    shaderCreateInfo.pCode = code;
 
     VkShaderModule shaderModule;
 
@@ -480,7 +1641,7 @@ void VulkanRenderer::initPipeline()
     //Set push contants data
     VkPushConstantRange pushConstants;
     pushConstants.offset = 0;
-    pushConstants.size = sizeof(ObjectPushConstants);
+    pushConstants.size = sizeof(ScenePushConstants);
     pushConstants.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 
     //Create pipeline layout
@@ -500,7 +1661,7 @@ void VulkanRenderer::initPipeline()
         return;
     }
 
-    vertexShader = createShaderModule("vertexshader.spv");
+    vertexShader = createShaderModule("vertexshader");
 
     if (vertexShader == NULL)
     {
@@ -508,7 +1669,7 @@ void VulkanRenderer::initPipeline()
         return;
     }
 
-    fragmentShader = createShaderModule("fragmentshader.spv");
+    fragmentShader = createShaderModule("fragmentshader");
 
     if (fragmentShader == NULL)
     {
@@ -516,6 +1677,50 @@ void VulkanRenderer::initPipeline()
         return;
     }
 
+    //Without valid cache file pipeline is compiled from scratch, cache is saved right away so next launch is fast
+    //even if this one doesn't end properly
+    if (!pipelineCache.create(vulkanDevice, physicalDevice, options.pipelineCacheFileName))
+    {
+        initSuccessful = false;
+        return;
+    }
+
+    stats.pipelineCacheLoaded = pipelineCache.isLoaded();
+
+    auto pipelineStartTime = std::chrono::steady_clock::now();
+
+    if (!buildPipeline(pipeline, vertexShader, fragmentShader))
+    {
+        initSuccessful = false;
+
+        return;
+    }
+
+    stats.pipelineSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - pipelineStartTime).count();
+
+    if (!stats.pipelineCacheLoaded)
+    {
+        pipelineCache.save();
+    }
+
+    if (!options.shaderSourceDirectory.empty())
+    {
+        ShaderReloader::Builder builder = [this](const std::vector<std::vector<uint32_t>>& shaderCode, ReloadedPipeline& reloaded)
+        {
+            return buildReloadedPipeline(shaderCode, reloaded);
+        };
+
+        //Reloading is only a development tool, game runs with current shaders without it
+        if (!shaderReloader.start(vulkanDevice, options.shaderSourceDirectory, { "vertexshader.vert", "fragmentshader.frag" }, builder))
+        {
+            std::cerr << "Watching shaders in " << options.shaderSourceDirectory << " failed" << std::endl;
+        }
+    }
+}
+
+//Uses only objects which don't change after initialization, so it can run on watcher thread while frames are rendered
+bool VulkanRenderer::buildPipeline(VulkanPipeline& pipeline, VkShaderModule vertexShader, VkShaderModule fragmentShader)
+{
     pipeline.addShaderStage(VK_SHADER_STAGE_VERTEX_BIT, vertexShader);
     pipeline.addShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT, fragmentShader);
 
@@ -525,31 +1730,89 @@ void VulkanRenderer::initPipeline()
 
     pipeline.setInputAssembly(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
 
-    VkViewport viewport;
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = (float)windowExtent.width;
-    viewport.height = (float)windowExtent.height;
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-
-    pipeline.setViewport(viewport);
-
-    VkRect2D scissor;
-    scissor.offset = { 0, 0 };
-    scissor.extent = windowExtent;
-
-    pipeline.setScissor(scissor);
+    //Viewport and scissor are set in every frame
+    pipeline.addDynamicState(VK_DYNAMIC_STATE_VIEWPORT);
+    pipeline.addDynamicState(VK_DYNAMIC_STATE_SCISSOR);
 
     pipeline.setRasterizer(VK_POLYGON_MODE_FILL);
     pipeline.setMultisampling();
     pipeline.setColorBlendAttachment();
     pipeline.setPipelineLayout(pipelineLayout);
-    
-    if (!pipeline.createPipeline(vulkanDevice, renderPass))
+
+    //Pipeline cache is internally synchronized, so watcher thread can use it too
+    return pipeline.createPipeline(vulkanDevice, renderPass, pipelineCache.getPipelineCache());
+}
+
+bool VulkanRenderer::buildReloadedPipeline(const std::vector<std::vector<uint32_t>>& shaderCode, ReloadedPipeline& reloaded)
+{
+    bool built = true;
+
+    for (const std::vector<uint32_t>& code : shaderCode)
     {
-        initSuccessful = false;
+        VkShaderModule shaderModule = createShaderModule(code.data(), code.size() * sizeof(uint32_t));
+
+        if (shaderModule == NULL)
+        {
+            built = false;
+
+            break;
+        }
+
+        reloaded.shaderModules.push_back(shaderModule);
+    }
+
+    built = built && buildPipeline(reloaded.pipeline, reloaded.shaderModules[0], reloaded.shaderModules[1]);
+
+    //Pipeline wasn't created, only shader modules are destroyed
+    if (!built)
+    {
+        for (VkShaderModule shaderModule : reloaded.shaderModules)
+        {
+            vkDestroyShaderModule(vulkanDevice, shaderModule, nullptr);
+        }
+
+        reloaded.shaderModules.clear();
+
+        return false;
+    }
 
+    return true;
+}
+
+//Called after fence of frame slot was waited, so frames up to finishedFrame don't use any old pipeline
+//Pipeline is replaced between frames, older frames in flight keep the pipeline they were recorded with
+void VulkanRenderer::swapReloadedPipeline(long long finishedFrame)
+{
+    for (int i = 0; i < (int)retiredPipelines.size(); )
+    {
+        if (retiredPipelines[i].lastFrame <= finishedFrame)
+        {
+            ShaderReloader::destroyPipeline(vulkanDevice, retiredPipelines[i]);
+            retiredPipelines.erase(retiredPipelines.begin() + i);
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    ReloadedPipeline reloaded;
+
+    if (!shaderReloader.takePipeline(reloaded))
+    {
         return;
     }
+
+    ReloadedPipeline retired;
+    retired.pipeline = pipeline;
+    retired.shaderModules = { vertexShader, fragmentShader };
+    retired.lastFrame = (long long)frameNumber - 1;
+
+    retiredPipelines.push_back(retired);
+
+    pipeline = reloaded.pipeline;
+    vertexShader = reloaded.shaderModules[0];
+    fragmentShader = reloaded.shaderModules[1];
+
+    commandsVersion++;
 }
@@ -1,18 +1,35 @@
 #version 450
 
-layout (location = 0) in vec3 aPosition;
-layout (location = 1) in vec3 aColor;
+layout (location = 0) in vec2 aPosition;
+
+//Per instance data
+layout (location = 1) in vec2 iPosition;
+layout (location = 2) in vec2 iSize;
+layout (location = 3) in vec4 iColor;
 
 layout (location = 0) out vec4 outColor;
 
 layout (push_constant) uniform constants
 {
-    vec4 colorVector;
-    mat4 mvpMatrix;
+    mat4 projectionMatrix; //Whole MVP matrix of shape when shapes are drawn one by one
+    vec4 shapeColor;
+    int perShape;
 } PushConstants;
 
 void main()
 {
-    gl_Position = PushConstants.mvpMatrix * vec4(aPosition, 1.0f);
-    outColor = PushConstants.colorVector;
+    //Renderer before instancing, position and size of shape are already in matrix
+    if (PushConstants.perShape != 0)
+    {
+        gl_Position = PushConstants.projectionMatrix * vec4(aPosition, -1.0f, 1.0f);
+        outColor = PushConstants.shapeColor;
+
+        return;
+    }
+
+    //Vertices are in -1..1 range and instance position is top left corner of shape
+    vec2 halfSize = iSize * 0.5f;
+
+    gl_Position = PushConstants.projectionMatrix * vec4(iPosition + halfSize + aPosition * halfSize, -1.0f, 1.0f);
+    outColor = iColor;
 }
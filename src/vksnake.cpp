@@ -1,20 +1,354 @@
 #include "Game.hpp"
+#include "Benchmark.hpp"
+#include "HeadlessGame.hpp"
+#include "BatchRunner.hpp"
+#include "Profiler.hpp"
+
 #include <iostream>
+#include <cstdio>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <climits>
+
+static bool getPresentMode(const char* name, VkPresentModeKHR& presentMode)
+{
+    if (strcmp(name, "fifo") == 0)
+    {
+        presentMode = VK_PRESENT_MODE_FIFO_KHR;
+    }
+    else if (strcmp(name, "fifo-relaxed") == 0)
+    {
+        presentMode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+    }
+    else if (strcmp(name, "mailbox") == 0)
+    {
+        presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+    }
+    else if (strcmp(name, "immediate") == 0)
+    {
+        presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
 
 int main(int argc, char* argv[])
 {
     int width = 960, height = 540;
+    int boardWidth = 48, boardHeight = 27;
 
-    if (argc > 1)
+    //Random seed unless given with -seed, it's printed so game can be repeated
+    uint64_t seed = std::chrono::system_clock::now().time_since_epoch().count();
+
+    bool headless = false;
+    long long ticks = 10000000;
+    std::string script;
+    std::string recordFileName, replayFileName;
+    long long seekTick = -1;
+    int benchmarkFrames = 0;
+    bool staticBenchmark = false;
+    bool offscreen = false;
+    std::string screenshotFileName;
+    std::string profileFileName;
+
+    RendererOptions rendererOptions;
+
+    BatchRunnerOptions batchOptions;
+    batchOptions.boardCount = 1;
+
+    for (int i = 1; i < argc; i++)
     {
-        if (strcmp(argv[1],"-fullscreen") == 0)
+        if (strcmp(argv[i],"-fullscreen") == 0)
         {
             width = -1;
             height = -1;
         }
+
+        //Board size in cells, for example -board 64x36
+        //At most 65536 cells like in replay files, each size is checked alone first so their product can't overflow
+        if (strcmp(argv[i], "-board") == 0 && i + 1 < argc)
+        {
+            i++;
+
+            if (sscanf(argv[i], "%dx%d", &boardWidth, &boardHeight) != 2 || boardWidth < 2 || boardHeight < 2 || boardWidth > 65536
+                || boardHeight > 65536 || boardWidth * boardHeight > 65536)
+            {
+                std::cerr << "Invalid board size: " << argv[i] << std::endl;
+
+                return EXIT_FAILURE;
+            }
+        }
+
+        if (strcmp(argv[i], "-seed") == 0 && i + 1 < argc)
+        {
+            seed = strtoull(argv[++i], NULL, 10);
+        }
+
+        //Run without window and renderer, bot plays unless -script is given
+        if (strcmp(argv[i], "-headless") == 0)
+        {
+            headless = true;
+        }
+
+        if (strcmp(argv[i], "-ticks") == 0 && i + 1 < argc)
+        {
+            ticks = atoll(argv[++i]);
+        }
+
+        //Directions used in headless mode, for example -script UURRDDLL
+        if (strcmp(argv[i], "-script") == 0 && i + 1 < argc)
+        {
+            script = argv[++i];
+        }
+
+        //Save replay of played game
+        if (strcmp(argv[i], "-record") == 0 && i + 1 < argc)
+        {
+            recordFileName = argv[++i];
+        }
+
+        //Play replay, in headless mode it's simulated to the end or to tick given with -seek
+        if (strcmp(argv[i], "-replay") == 0 && i + 1 < argc)
+        {
+            replayFileName = argv[++i];
+        }
+
+        if (strcmp(argv[i], "-seek") == 0 && i + 1 < argc)
+        {
+            seekTick = atoll(argv[++i]);
+        }
+
+        //Many boards on all threads in headless mode, for example -boards 16384 -threads 8 -batch-size 256 -no-reset
+        if (strcmp(argv[i], "-boards") == 0 && i + 1 < argc)
+        {
+            batchOptions.boardCount = atoi(argv[++i]);
+        }
+
+        if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
+        {
+            batchOptions.threadCount = atoi(argv[++i]);
+        }
+
+        if (strcmp(argv[i], "-batch-size") == 0 && i + 1 < argc)
+        {
+            batchOptions.batchSize = atoi(argv[++i]);
+        }
+
+        if (strcmp(argv[i], "-no-reset") == 0)
+        {
+            batchOptions.autoReset = false;
+        }
+
+        //Render like before instancing (matrix, push constants and draw call for every shape), CPU time per frame is printed at exit
+        //Commands contain matrices of shapes, so they are recorded in every frame like with -no-reuse-commands
+        if (strcmp(argv[i], "-draw-per-shape") == 0)
+        {
+            rendererOptions.drawPerShape = true;
+            rendererOptions.reuseCommands = false;
+        }
+
+        //Record commands in every frame instead of submitting the same commands again, for comparing CPU time per frame
+        if (strcmp(argv[i], "-no-reuse-commands") == 0)
+        {
+            rendererOptions.reuseCommands = false;
+        }
+
+        if (strcmp(argv[i], "-frames-in-flight") == 0 && i + 1 < argc)
+        {
+            rendererOptions.framesInFlight = std::max(1, atoi(argv[++i]));
+        }
+
+        //Print GPU time measured with timestamp queries every given number of frames
+        if (strcmp(argv[i], "-gpu-timing") == 0 && i + 1 < argc)
+        {
+            rendererOptions.gpuTimingLogInterval = std::max(1, atoi(argv[++i]));
+        }
+
+        //fifo (vertical sync), fifo-relaxed, mailbox or immediate
+        if (strcmp(argv[i], "-present-mode") == 0 && i + 1 < argc)
+        {
+            i++;
+
+            if (!getPresentMode(argv[i], rendererOptions.presentMode))
+            {
+                std::cerr << "Invalid present mode: " << argv[i] << std::endl;
+
+                return EXIT_FAILURE;
+            }
+        }
+
+        //Render fixed scene for given number of frames, use with -present-mode immediate or mailbox to measure above vertical sync
+        if (strcmp(argv[i], "-benchmark") == 0 && i + 1 < argc)
+        {
+            benchmarkFrames = std::max(1, atoi(argv[++i]));
+        }
+
+        //Benchmark scene doesn't change, for measuring frames which only submit reused commands
+        if (strcmp(argv[i], "-benchmark-static") == 0)
+        {
+            staticBenchmark = true;
+        }
+
+        //Render benchmark without window to offscreen images, works on devices without presentation (for example lavapipe)
+        //Last frame can be saved with -screenshot file.ppm and compared with reference image
+        if (strcmp(argv[i], "-offscreen") == 0)
+        {
+            offscreen = true;
+        }
+
+        if (strcmp(argv[i], "-screenshot") == 0 && i + 1 < argc)
+        {
+            screenshotFileName = argv[++i];
+        }
+
+        //Save every rendered frame on background thread, format is selected by extension: .ppm, .y4m or raw RGB
+        //For example -capture session.y4m or -capture frame%05d.ppm
+        if (strcmp(argv[i], "-capture") == 0 && i + 1 < argc)
+        {
+            rendererOptions.captureFileName = argv[++i];
+        }
+
+        //Use SPIR-V files from directory (make spv) instead of shaders built into game
+        if (strcmp(argv[i], "-shader-dir") == 0 && i + 1 < argc)
+        {
+            rendererOptions.shaderDirectory = argv[++i];
+        }
+
+        //Rebuild pipeline when shader sources are saved, for example -watch-shaders src/shaders (needs glslc)
+        if (strcmp(argv[i], "-watch-shaders") == 0 && i + 1 < argc)
+        {
+            rendererOptions.shaderSourceDirectory = argv[++i];
+        }
+
+        //Pipeline cache file, pipelinecache.bin by default
+        if (strcmp(argv[i], "-pipeline-cache") == 0 && i + 1 < argc)
+        {
+            rendererOptions.pipelineCacheFileName = argv[++i];
+        }
+
+        //Always compile pipeline, for measuring cold start
+        if (strcmp(argv[i], "-no-pipeline-cache") == 0)
+        {
+            rendererOptions.pipelineCacheFileName.clear();
+        }
+
+        //Record CPU zones and save them as Chrome trace JSON at exit
+        if (strcmp(argv[i], "-profile") == 0 && i + 1 < argc)
+        {
+            profileFileName = argv[++i];
+
+            Profiler::setEnabled(true);
+        }
+
+        if (strcmp(argv[i], "-benchmark-board") == 0)
+        {
+            Benchmark::runBoardBenchmark();
+
+            return EXIT_SUCCESS;
+        }
+
+        if (strcmp(argv[i], "-benchmark-occupancy") == 0)
+        {
+            Benchmark::runOccupancyBenchmark();
+
+            return EXIT_SUCCESS;
+        }
+
+        if (strcmp(argv[i], "-benchmark-board-size") == 0)
+        {
+            Benchmark::runBoardSizeBenchmark();
+
+            return EXIT_SUCCESS;
+        }
+
+        if (strcmp(argv[i], "-benchmark-batch") == 0)
+        {
+            Benchmark::runBatchBenchmark();
+
+            return EXIT_SUCCESS;
+        }
+
+        if (strcmp(argv[i], "-benchmark-batch-check") == 0)
+        {
+            return Benchmark::runBatchCheck() ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        if (strcmp(argv[i], "-benchmark-threads") == 0)
+        {
+            Benchmark::runThreadScalingBenchmark();
+
+            return EXIT_SUCCESS;
+        }
     }
 
+    //Selected mode is run in lambda so profile can be saved after any of them
+    auto runMode = [&]() -> int
+    {
+        if (headless && !replayFileName.empty())
+        {
+            return HeadlessGame::playReplay(replayFileName, seekTick);
+        }
+
+        std::cout << "Seed: " << seed << std::endl;
+
+        if (headless && batchOptions.boardCount > 1)
+        {
+            batchOptions.boardSize = DynamicBoardSize(boardWidth, boardHeight);
+            batchOptions.seed = seed;
+
+            BatchRunner runner(batchOptions);
+
+            //Every board makes ticks / boards moves so total work is the same as with single board
+            int steps = (int)std::min((long long)INT_MAX, std::max(1LL, ticks / batchOptions.boardCount));
+            BatchRunnerStats stats = runner.run(steps);
+
+            std::cout << batchOptions.boardCount << " boards on " << runner.getThreadCount() << " threads: " << stats.boardTicks << " ticks in "
+                << stats.seconds << " s (" << stats.boardTicks / stats.seconds << " ticks/s), " << stats.games << " finished games, "
+                << stats.stolenShards << " stolen shards" << std::endl;
+
+            return EXIT_SUCCESS;
+        }
+
+        if (headless)
+        {
+            HeadlessGame headlessGame(boardWidth, boardHeight, seed);
+            headlessGame.setScript(script);
+
+            return headlessGame.run(ticks);
+        }
+
+        Game game(width, height, boardWidth, boardHeight, seed);
+        game.setRecordFile(recordFileName);
+        game.setReplayFile(replayFileName);
+        game.setRendererOptions(rendererOptions);
+        game.setOffscreen(offscreen);
+        game.setScreenshotFile(screenshotFileName);
+
+        if (benchmarkFrames > 0)
+        {
+            return game.runBenchmark(benchmarkFrames, staticBenchmark);
+        }
+
+        return game.run();
+    };
+
+    int result = runMode();
+
+    if (!profileFileName.empty())
+    {
+        Profiler::setEnabled(false);
+
+        if (!Profiler::exportChromeTrace(profileFileName))
+        {
+            std::cerr << "Saving profile " << profileFileName << " failed!" << std::endl;
+        }
+    }
 
-    Game game(width, height);
-    return game.run();
+    return result;
 }